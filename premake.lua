@@ -41,7 +41,7 @@ end
 -- ------------------------------------------------------------------------------
 workspace ("Tether_" .. _ACTION)
 
-    configurations  { "Debug", "Release", "Release-AVX2" }
+    configurations  { "Debug", "Release", "Release-AVX2", "Release-MultiISA" }
     platforms       { "x86", "x86_64" }
 
     useISPC()
@@ -109,8 +109,38 @@ workspace ("Tether_" .. _ACTION)
             TargetISA   = "avx2-i32x16",
         }
 
+    -- one binary for any x64 host; ISPC compiles every .ispc for each of MultiISATargets and picks the best at runtime,
+    -- the C++ side stays on the baseline instruction set so it can start anywhere
+    filter "configurations:Release-MultiISA"
+        defines   { "NDEBUG" }
+        flags     { "LinkTimeOptimization" }
+        optimize  "Full"
+
+    filter { "configurations:Release-MultiISA", "platforms:x86_64" }
+        defines   { "TETHER_ISPC_MULTI_TARGET" }
+        vectorextensions "SSE2"
+        ispcVars  {
+            CPU         = "unspecified",
+            TargetISA   = "multi-sse4-avx2-avx512skx",
+        }
+
+    -- the *.narrow.ispc wrappers build the samples a second time at half the gang width of the configuration, for the
+    -- ispc_half_width rows in main.cpp. their exports are renamed, but anything else non-static in a sample would be
+    -- defined by both objects, so keep helper functions and tasks in the .ispc files static
+    filter { "files:src/ispc/*.narrow.ispc", "platforms:x86" }
+        ispcVars  { TargetISA = "sse2-i32x4" }
+    filter { "files:src/ispc/*.narrow.ispc", "platforms:x86_64" }
+        ispcVars  { TargetISA = "avx1-i32x8" }
+    filter { "files:src/ispc/*.narrow.ispc", "configurations:Release-AVX2" }
+        ispcVars  { TargetISA = "avx2-i32x8" }
+    filter { "files:src/ispc/*.narrow.ispc", "configurations:Release-MultiISA", "platforms:x86_64" }
+        ispcVars  { TargetISA = "multi-sse4-avx2-avx512skx-narrow" }
+
     filter {}
 
+-- must match the ISA suffixes ISPC gives per-target objects for the TargetISA above
+MultiISATargets = { "sse4", "avx2", "avx512skx" }
+
 
 -- ------------------------------------------------------------------------------
 project "Tether"
@@ -120,6 +150,17 @@ project "Tether"
     ConfigureCommonBuildSettings()
     ConfigureCommonBuildFiles()
 
+    -- with multiple targets, ISPC writes an object per target next to the dispatch object named by ObjectFileName;
+    -- MSBuild only knows about the latter, so link the rest by hand (as the Raspberry build does for its objects)
+    filter { "configurations:Release-MultiISA", "platforms:x86_64" }
+        for i, ifile in ipairs(os.matchfiles("src/ispc/*.ispc")) do
+            justFilename = GetFileNameNoExtension(ifile)
+            for t, isa in ipairs(MultiISATargets) do
+                linkoptions { string.format( "$(IntDir)%s_%s.obj", justFilename, isa ) }
+            end
+        end
+    filter {}
+
 
 -- ------------------------------------------------------------------------------
 workspace ("Tether_Raspberry_" .. _ACTION)
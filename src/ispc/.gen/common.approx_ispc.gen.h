@@ -0,0 +1,48 @@
+//
+// src\ispc\.gen/common.approx_ispc.gen.h
+// (Header automatically generated by the ispc compiler.)
+// DO NOT EDIT THIS FILE.
+//
+
+#pragma once
+#include <stdint.h>
+
+
+
+#ifdef __cplusplus
+namespace ispc { /* namespace */
+#endif // __cplusplus
+
+#ifndef __ISPC_ALIGN__
+#if defined(__clang__) || !defined(_MSC_VER)
+// Clang, GCC, ICC
+#define __ISPC_ALIGN__(s) __attribute__((aligned(s)))
+#define __ISPC_ALIGNED_STRUCT__(s) struct __ISPC_ALIGN__(s)
+#else
+// Visual Studio
+#define __ISPC_ALIGN__(s) __declspec(align(s))
+#define __ISPC_ALIGNED_STRUCT__(s) __ISPC_ALIGN__(s) struct
+#endif
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////
+// Functions exported from ispc code
+///////////////////////////////////////////////////////////////////////////
+#if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
+extern "C" {
+#endif // __cplusplus
+    extern void approxAcos_batch(const float * xs, float * out, int32_t n, int32_t tier);
+    extern void approxAtan_batch(const float * xs, float * out, int32_t n, int32_t tier);
+    extern void approxCos_batch(const float * xs, float * out, int32_t n, int32_t tier);
+    extern void approxExp_batch(const float * xs, float * out, int32_t n, int32_t tier);
+    extern void approxPow_batch(const float * xs, const float * ys, float * out, int32_t n, int32_t tier);
+    extern void approxSin_batch(const float * xs, float * out, int32_t n, int32_t tier);
+#if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
+} /* end extern C */
+#endif // __cplusplus
+
+
+#ifdef __cplusplus
+} /* namespace */
+#endif // __cplusplus
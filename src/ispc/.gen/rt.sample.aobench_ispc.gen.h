@@ -33,6 +33,8 @@ namespace ispc { /* namespace */
 extern "C" {
 #endif // __cplusplus
     extern void renderImageAmbientOcclusion(const int32_t output_width, const int32_t output_height, const int32_t nsubsamples, float * image);
+    extern void renderImageAmbientOcclusion_seeded(const int32_t output_width, const int32_t output_height, const int32_t nsubsamples, float * image);
+    extern void renderImageAmbientOcclusion_tasks(const int32_t output_width, const int32_t output_height, const int32_t nsubsamples, float * image, const int32_t tile_width, const int32_t tile_height);
 #if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
 } /* end extern C */
 #endif // __cplusplus
@@ -33,6 +33,7 @@ namespace ispc { /* namespace */
 extern "C" {
 #endif // __cplusplus
     extern void renderImageClouds(const int32_t output_width, const int32_t output_height, uint32_t * output);
+    extern void renderImageClouds_tasks(const int32_t output_width, const int32_t output_height, uint32_t * output, const int32_t tile_width, const int32_t tile_height);
 #if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
 } /* end extern C */
 #endif // __cplusplus
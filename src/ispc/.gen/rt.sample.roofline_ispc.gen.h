@@ -0,0 +1,50 @@
+//
+// src\ispc\.gen/rt.sample.roofline_ispc.gen.h
+// (Header automatically generated by the ispc compiler.)
+// DO NOT EDIT THIS FILE.
+//
+
+#pragma once
+#include <stdint.h>
+
+
+
+#ifdef __cplusplus
+namespace ispc { /* namespace */
+#endif // __cplusplus
+
+#ifndef __ISPC_ALIGN__
+#if defined(__clang__) || !defined(_MSC_VER)
+// Clang, GCC, ICC
+#define __ISPC_ALIGN__(s) __attribute__((aligned(s)))
+#define __ISPC_ALIGNED_STRUCT__(s) struct __ISPC_ALIGN__(s)
+#else
+// Visual Studio
+#define __ISPC_ALIGN__(s) __declspec(align(s))
+#define __ISPC_ALIGNED_STRUCT__(s) __ISPC_ALIGN__(s) struct
+#endif
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////
+// Functions exported from ispc code
+///////////////////////////////////////////////////////////////////////////
+#if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
+extern "C" {
+#endif // __cplusplus
+    extern void rooflineCopy(float * destination, const float * source, const int32_t count, const int32_t passes);
+    extern void rooflineCopy_tasks(float * destination, const float * source, const int32_t count, const int32_t passes, const int32_t tasks);
+    extern float rooflineFMA(const int32_t iterations, const float seed);
+    extern float rooflineFMA_tasks(const int32_t iterations, const float seed, const int32_t tasks);
+    extern float rooflineRead(const float * data, const int32_t count, const int32_t passes);
+    extern float rooflineRead_tasks(const float * data, const int32_t count, const int32_t passes, const int32_t tasks);
+    extern void rooflineWrite(float * data, const int32_t count, const int32_t passes);
+    extern void rooflineWrite_tasks(float * data, const int32_t count, const int32_t passes, const int32_t tasks);
+#if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
+} /* end extern C */
+#endif // __cplusplus
+
+
+#ifdef __cplusplus
+} /* namespace */
+#endif // __cplusplus
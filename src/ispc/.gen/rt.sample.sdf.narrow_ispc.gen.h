@@ -0,0 +1,61 @@
+//
+// src\ispc\.gen/rt.sample.sdf.narrow_ispc.gen.h
+// (Header automatically generated by the ispc compiler.)
+// DO NOT EDIT THIS FILE.
+//
+
+#pragma once
+#include <stdint.h>
+
+
+
+#ifdef __cplusplus
+namespace ispc { /* namespace */
+#endif // __cplusplus
+///////////////////////////////////////////////////////////////////////////
+// Vector types with external visibility from ispc code
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef __ISPC_VECTOR_float2__
+#define __ISPC_VECTOR_float2__
+#ifdef _MSC_VER
+__declspec( align(8) ) struct float2 { float v[2]; };
+#else
+struct float2 { float v[2]; } __attribute__ ((aligned(8)));
+#endif
+#endif
+
+
+
+#ifndef __ISPC_ALIGN__
+#if defined(__clang__) || !defined(_MSC_VER)
+// Clang, GCC, ICC
+#define __ISPC_ALIGN__(s) __attribute__((aligned(s)))
+#define __ISPC_ALIGNED_STRUCT__(s) struct __ISPC_ALIGN__(s)
+#else
+// Visual Studio
+#define __ISPC_ALIGN__(s) __declspec(align(s))
+#define __ISPC_ALIGNED_STRUCT__(s) __ISPC_ALIGN__(s) struct
+#endif
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////
+// Functions exported from ispc code
+///////////////////////////////////////////////////////////////////////////
+#if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
+extern "C" {
+#endif // __cplusplus
+    extern void polygonsToSDF_edt_narrow(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y);
+    extern void polygonsToSDF_grid_narrow(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y, const int32_t cell_pixels);
+    extern void polygonsToSDF_narrow(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y);
+    extern void polygonsToSDF_tiles_narrow(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y, const int32_t tile_pixels, float * tile_bounds);
+    extern int32_t polygonsToSDF_update_narrow(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, const int32_t * changed_vertices, const float2   * changed_previous, const int32_t changed_count, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y, const int32_t tile_pixels, float * tile_bounds);
+#if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
+} /* end extern C */
+#endif // __cplusplus
+
+
+#ifdef __cplusplus
+} /* namespace */
+#endif // __cplusplus
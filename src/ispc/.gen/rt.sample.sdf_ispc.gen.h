@@ -47,6 +47,10 @@ struct float2 { float v[2]; } __attribute__ ((aligned(8)));
 extern "C" {
 #endif // __cplusplus
     extern void polygonsToSDF(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y);
+    extern void polygonsToSDF_edt(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y);
+    extern void polygonsToSDF_grid(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y, const int32_t cell_pixels);
+    extern void polygonsToSDF_tiles(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y, const int32_t tile_pixels, float * tile_bounds);
+    extern int32_t polygonsToSDF_update(const float2   * vertices, const int32_t * polygonSizes, const int32_t polygonCount, const int32_t * changed_vertices, const float2   * changed_previous, const int32_t changed_count, float * sdf_output, int32_t sdf_output_width, int32_t sdf_output_height, const float world_start_x, const float world_start_y, const float world_size_x, const float world_size_y, const int32_t tile_pixels, float * tile_bounds);
 #if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
 } /* end extern C */
 #endif // __cplusplus
@@ -0,0 +1,175 @@
+// ---------------------------------------------------------------------------------------------------------------------
+// Tether-ISPC by Harry Denholm, ishani.org 2020
+// https://github.com/ishani/Tether-ISPC
+// ---------------------------------------------------------------------------------------------------------------------
+// binds the entries in rt.dispatch.h to ispc's dispatching exports, or to one target's variants
+//
+
+#include <string.h>
+
+#include "rt.dispatch.h"
+
+#if defined(TETHER_ISPC_MULTI_TARGET)
+
+#ifdef WIN32
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+// with more than one target, ISPC compiles each export once per target with the ISA appended to its name, and the
+// unadorned export becomes a small function that calls whichever of those suits the host
+namespace ispc {
+extern "C" {
+
+#define TETHER_ISPC_VARIANTS( _fn )             \
+    extern decltype( _fn ) _fn##_sse4;          \
+    extern decltype( _fn ) _fn##_avx2;          \
+    extern decltype( _fn ) _fn##_avx512skx;
+
+    TETHER_ISPC_EXPORTS( TETHER_ISPC_VARIANTS )
+
+#undef TETHER_ISPC_VARIANTS
+
+} // extern "C"
+} // namespace ispc
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// the same checks ISPC's dispatch makes, so forcing a target can't pick one it would refuse to run
+
+static void cpuid( const uint32_t leaf, const uint32_t subleaf, uint32_t regs[4] )
+{
+#ifdef WIN32
+    __cpuidex( reinterpret_cast<int*>( regs ), (int)leaf, (int)subleaf );
+#else
+    __cpuid_count( leaf, subleaf, regs[0], regs[1], regs[2], regs[3] );
+#endif
+}
+
+// register state the OS saves on context switch; AVX needs XMM|YMM, AVX-512 also needs the opmask and ZMM state
+static uint64_t enabledXSaveState()
+{
+#ifdef WIN32
+    return _xgetbv( 0 );
+#else
+    uint32_t lo, hi;
+    __asm__ __volatile__( "xgetbv" : "=a"( lo ), "=d"( hi ) : "c"( 0 ) );
+    return ( (uint64_t)hi << 32 ) | lo;
+#endif
+}
+
+static bool hostSupports( const ispc_isa::Target target )
+{
+    uint32_t leaf1[4];
+    cpuid( 1, 0, leaf1 );
+
+    const bool sse41 = ( leaf1[2] & ( 1u << 19 ) ) != 0;
+    if ( target == ispc_isa::Target::SSE4 )
+        return sse41;
+
+    const bool osxsave = ( leaf1[2] & ( 1u << 27 ) ) != 0;
+    const bool avx     = ( leaf1[2] & ( 1u << 28 ) ) != 0;
+    if ( !osxsave || !avx || ( enabledXSaveState() & 0x6 ) != 0x6 )
+        return false;
+
+    uint32_t leaf7[4];
+    cpuid( 7, 0, leaf7 );
+
+    const bool fma  = ( leaf1[2] & ( 1u << 12 ) ) != 0;
+    const bool f16c = ( leaf1[2] & ( 1u << 29 ) ) != 0;
+    const bool avx2 = ( leaf7[1] & ( 1u << 5 ) ) != 0;
+    if ( target == ispc_isa::Target::AVX2 )
+        return avx2 && fma && f16c;
+
+    // skx; foundation, doubleword/quadword, conflict detection, byte/word and vector length extensions
+    const uint32_t skxBits = ( 1u << 16 ) | ( 1u << 17 ) | ( 1u << 28 ) | ( 1u << 30 ) | ( 1u << 31 );
+    if ( target == ispc_isa::Target::AVX512SKX )
+        return avx2 && ( leaf7[1] & skxBits ) == skxBits && ( enabledXSaveState() & 0xE6 ) == 0xE6;
+
+    return false;
+}
+
+#endif // TETHER_ISPC_MULTI_TARGET
+
+
+namespace ispc_isa
+{
+
+#define TETHER_ISPC_ENTRY( _fn )    decltype( &ispc::_fn ) _fn = &ispc::_fn;
+    TETHER_ISPC_EXPORTS( TETHER_ISPC_ENTRY )
+#undef TETHER_ISPC_ENTRY
+
+static Target selectedTarget = Target::Auto;
+
+static const char* targetNames[] = { "auto", "sse4", "avx2", "avx512skx" };
+
+const char* targetName( const Target target )
+{
+    return targetNames[ (int)target ];
+}
+
+bool targetFromName( const char* name, Target& target )
+{
+    for ( int i = 0; i < (int)( sizeof( targetNames ) / sizeof( targetNames[0] ) ); i++ )
+    {
+        if ( strcmp( name, targetNames[i] ) == 0 )
+        {
+            target = (Target)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool available( const Target target )
+{
+    if ( target == Target::Auto )
+        return true;
+
+#if defined(TETHER_ISPC_MULTI_TARGET)
+    return hostSupports( target );
+#else
+    return false;
+#endif
+}
+
+bool select( const Target target )
+{
+    if ( !available( target ) )
+        return false;
+
+#define TETHER_ISPC_BIND( _fn, _suffix )    _fn = &ispc::_fn##_suffix;
+#define TETHER_ISPC_BIND_AUTO( _fn )        TETHER_ISPC_BIND( _fn, )
+#define TETHER_ISPC_BIND_SSE4( _fn )        TETHER_ISPC_BIND( _fn, _sse4 )
+#define TETHER_ISPC_BIND_AVX2( _fn )        TETHER_ISPC_BIND( _fn, _avx2 )
+#define TETHER_ISPC_BIND_AVX512SKX( _fn )   TETHER_ISPC_BIND( _fn, _avx512skx )
+
+    switch ( target )
+    {
+        case Target::Auto:      TETHER_ISPC_EXPORTS( TETHER_ISPC_BIND_AUTO ) break;
+#if defined(TETHER_ISPC_MULTI_TARGET)
+        case Target::SSE4:      TETHER_ISPC_EXPORTS( TETHER_ISPC_BIND_SSE4 ) break;
+        case Target::AVX2:      TETHER_ISPC_EXPORTS( TETHER_ISPC_BIND_AVX2 ) break;
+        case Target::AVX512SKX: TETHER_ISPC_EXPORTS( TETHER_ISPC_BIND_AVX512SKX ) break;
+#endif
+        default:
+            return false;
+    }
+
+#undef TETHER_ISPC_BIND_AVX512SKX
+#undef TETHER_ISPC_BIND_AVX2
+#undef TETHER_ISPC_BIND_SSE4
+#undef TETHER_ISPC_BIND_AUTO
+#undef TETHER_ISPC_BIND
+
+    selectedTarget = target;
+    return true;
+}
+
+Target selected()
+{
+    return selectedTarget;
+}
+
+} // namespace ispc_isa
@@ -0,0 +1,100 @@
+// ---------------------------------------------------------------------------------------------------------------------
+// Tether-ISPC by Harry Denholm, ishani.org 2020
+// https://github.com/ishani/Tether-ISPC
+// ---------------------------------------------------------------------------------------------------------------------
+// a pointer for every ISPC export, so the benchmarks can force one particular target rather than always taking the
+// one ispc's runtime dispatch would choose. by default each points straight at the ispc:: export; in a multi-target
+// build (TETHER_ISPC_MULTI_TARGET, the Release-MultiISA configuration in premake.lua) that export picks the best
+// variant for the host CPU, and select() can rebind everything to the sse4, avx2 or avx512skx variants directly
+//
+
+#pragma once
+
+#include "rt.exports.h"
+
+// X( name ) for every function exported from the .ispc files; keep in step with the .gen headers
+#define TETHER_ISPC_EXPORTS( X )                   \
+    X( approxAcos_batch )                          \
+    X( approxAtan_batch )                          \
+    X( approxCos_batch )                           \
+    X( approxExp_batch )                           \
+    X( approxPow_batch )                           \
+    X( approxSin_batch )                           \
+    X( SDFToRGB )                                  \
+    X( float1ToRGB )                               \
+    X( cellular2D_batch )                          \
+    X( noise_batch )                               \
+    X( perlin3D_batch )                            \
+    X( targetISA )                                 \
+    X( targetWidth )                               \
+    X( renderImageAmbientOcclusion )               \
+    X( renderImageAmbientOcclusion_seeded )        \
+    X( renderImageAmbientOcclusion_tasks )         \
+    X( renderImageClouds )                         \
+    X( renderImageClouds_tasks )                   \
+    X( fft_1024_extract_lowband )                  \
+    X( fft_1024_unrolled )                         \
+    X( renderImageNoiseBall )                      \
+    X( rooflineCopy )                              \
+    X( rooflineCopy_tasks )                        \
+    X( rooflineFMA )                               \
+    X( rooflineFMA_tasks )                         \
+    X( rooflineRead )                              \
+    X( rooflineRead_tasks )                        \
+    X( rooflineWrite )                             \
+    X( rooflineWrite_tasks )                       \
+    X( shortVecChain )                             \
+    X( polygonsToSDF )                             \
+    X( polygonsToSDF_edt )                         \
+    X( polygonsToSDF_grid )                        \
+    X( polygonsToSDF_tiles )                       \
+    X( polygonsToSDF_update )                      \
+    X( synthLoop )                                 \
+    X( flatLaunch )                                \
+    X( nestedLaunchTree )                          \
+    X( targetISA_narrow )                          \
+    X( targetWidth_narrow )                        \
+    X( renderImageAmbientOcclusion_narrow )        \
+    X( renderImageAmbientOcclusion_seeded_narrow ) \
+    X( renderImageAmbientOcclusion_tasks_narrow )  \
+    X( renderImageClouds_narrow )                  \
+    X( renderImageClouds_tasks_narrow )            \
+    X( fft_1024_extract_lowband_narrow )           \
+    X( fft_1024_unrolled_narrow )                  \
+    X( renderImageNoiseBall_narrow )               \
+    X( polygonsToSDF_narrow )                      \
+    X( polygonsToSDF_edt_narrow )                  \
+    X( polygonsToSDF_grid_narrow )                 \
+    X( polygonsToSDF_tiles_narrow )                \
+    X( polygonsToSDF_update_narrow )               \
+    X( synthLoop_narrow )                          \
+    X( renderImageClouds_approx )                  \
+    X( renderImageClouds_tasks_approx )            \
+    X( synthLoop_approx )
+
+namespace ispc_isa
+{
+    enum class Target
+    {
+        Auto,           // ispc's own dispatch; the best target in the build that the host supports
+        SSE4,
+        AVX2,
+        AVX512SKX,
+    };
+
+    // command line names; "auto", "sse4", "avx2", "avx512skx"
+    const char* targetName( const Target target );
+    bool targetFromName( const char* name, Target& target );
+
+    // true if the build contains the target's variants and the host CPU can run them
+    bool available( const Target target );
+
+    // point every entry at the given target's variants; returns false, leaving the current selection alone, if
+    // the target isn't available
+    bool select( const Target target );
+    Target selected();
+
+#define TETHER_ISPC_ENTRY( _fn )    extern decltype( &ispc::_fn ) _fn;
+    TETHER_ISPC_EXPORTS( TETHER_ISPC_ENTRY )
+#undef TETHER_ISPC_ENTRY
+}
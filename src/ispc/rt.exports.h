@@ -1,5 +1,8 @@
 #pragma once
+#include ".gen/common.approx_ispc.gen.h"
 #include ".gen/common.conversion_ispc.gen.h"
+#include ".gen/common.noise_ispc.gen.h"
+#include ".gen/common.target_ispc.gen.h"
 
 #include ".gen/rt.sample.sdf_ispc.gen.h"
 #include ".gen/rt.sample.clouds_ispc.gen.h"
@@ -7,3 +10,20 @@
 #include ".gen/rt.sample.aobench_ispc.gen.h"
 #include ".gen/rt.sample.synth_ispc.gen.h"
 #include ".gen/rt.sample.fft_ispc.gen.h"
+#include ".gen/rt.sample.tasks_ispc.gen.h"
+#include ".gen/rt.sample.roofline_ispc.gen.h"
+#include ".gen/rt.sample.shortvec_ispc.gen.h"
+
+// the same samples built at half the gang width, exports suffixed with _narrow
+#include ".gen/common.target.narrow_ispc.gen.h"
+
+#include ".gen/rt.sample.sdf.narrow_ispc.gen.h"
+#include ".gen/rt.sample.clouds.narrow_ispc.gen.h"
+#include ".gen/rt.sample.noise.narrow_ispc.gen.h"
+#include ".gen/rt.sample.aobench.narrow_ispc.gen.h"
+#include ".gen/rt.sample.synth.narrow_ispc.gen.h"
+#include ".gen/rt.sample.fft.narrow_ispc.gen.h"
+
+// samples built again with the approximate tiers of common.approx.inl.isph, exports suffixed with _approx
+#include ".gen/rt.sample.clouds.approx_ispc.gen.h"
+#include ".gen/rt.sample.synth.approx_ispc.gen.h"
@@ -134,6 +134,13 @@ inline float floatbits(const uint32_t u32)
     return ret;
 }
 
+inline uint32_t intbits(const float f)
+{
+    uint32_t ret;
+    memcpy(&ret, &f, sizeof(uint32_t));
+    return ret;
+}
+
 struct RNGState 
 {
     uint32_t z1, z2, z3, z4;
@@ -183,10 +190,21 @@ inline float frandom(RNGState* state)
 #define reduce_min
 #define reduce_max
 
+// a gang of one
+#define programCount    (1)
+#define programIndex    (0)
+
 #define tiled_iteration_xy( _type, _width, _height )        \
             for ( _type y = (_type)0; y < _height; y ++ )   \
             for ( _type x = (_type)0; x < _width; x ++ )
 
+#define tiled_iteration_region_xy( _type, _x0, _y0, _x1, _y1 )     \
+            for ( _type y = (_type)_y0; y < _y1; y ++ )             \
+            for ( _type x = (_type)_x0; x < _x1; x ++ )
+
+#define linear_iteration( _var, _start, _end )          \
+            for ( int _var = _start; _var < _end; _var ++ )
+
 
 // ---------------------------------------------------------------------------------------------------------------------
 // construction syntax differs just enough to be annoying, which is why we use macros to wrap and adapt it; more details 
@@ -261,6 +279,7 @@ constexpr const T& clamp(const T& v, const T& lo, const T& hi)
 #define _tether_arg3_double     const _tether_arg3_decl double
 
 #include "common.math.inl.isph"
+#include "common.approx.inl.isph"
 #include "common.matrix.inl.isph"
 #include "common.random.inl.isph"
 #include "common.noise.inl.isph"
@@ -0,0 +1,15 @@
+// ---------------------------------------------------------------------------------------------------------------------
+// Tether-ISPC by Harry Denholm, ishani.org 2020
+// https://github.com/ishani/Tether-ISPC
+// ---------------------------------------------------------------------------------------------------------------------
+// 
+//
+
+#include "serial.common.h"
+
+TETHER_SERIAL_NAMESPACE_OPEN
+
+#include "common.noise.ispc"
+
+TETHER_SERIAL_NAMESPACE_CLOSE
+
@@ -8,6 +8,17 @@ using float2 = swizzle::glsl::naive::vector< float, 2 >;
 namespace serial 
 {
 
+    void approxAcos_batch( const float xs[], float out[], const int32_t n, const int32_t tier );
+    void approxAtan_batch( const float xs[], float out[], const int32_t n, const int32_t tier );
+    void approxCos_batch( const float xs[], float out[], const int32_t n, const int32_t tier );
+    void approxExp_batch( const float xs[], float out[], const int32_t n, const int32_t tier );
+    void approxPow_batch( const float xs[], const float ys[], float out[], const int32_t n, const int32_t tier );
+    void approxSin_batch( const float xs[], float out[], const int32_t n, const int32_t tier );
+
+    void cellular2D_batch( const float xs[], const float ys[], float out[], const int32_t n );
+    void noise_batch( const float xs[], const float ys[], const float zs[], float out[], const int32_t n );
+    void perlin3D_batch( const float xs[], const float ys[], const float zs[], float out[], const int32_t n );
+
     void renderImageClouds(
         const int32_t   output_width,
         const int32_t   output_height,
@@ -24,11 +35,21 @@ namespace serial
         const int32_t   h,
         const int32_t   nsubsamples,
         float           image[] );
+    void renderImageAmbientOcclusion_seeded(
+        const int32_t   w,
+        const int32_t   h,
+        const int32_t   nsubsamples,
+        float           image[] );
     void renderImageAmbientOcclusion_ManuallyPorted(
         const int32_t   w,
         const int32_t   h,
         const int32_t   nsubsamples,
         float*          image );
+    void renderImageAmbientOcclusion_ManuallyPorted_seeded(
+        const int32_t   w,
+        const int32_t   h,
+        const int32_t   nsubsamples,
+        float*          image );
 
     void polygonsToSDF(
         const float2 vertices[],
@@ -41,6 +62,58 @@ namespace serial
         const float world_start_y,
         const float world_size_x,
         const float world_size_y );
+    void polygonsToSDF_edt(
+        const float2 vertices[],
+        const int32_t polygonSizes[],
+        const int32_t polygonCount,
+        float sdf_output[],
+        int32_t sdf_output_width,
+        int32_t sdf_output_height,
+        const float world_start_x,
+        const float world_start_y,
+        const float world_size_x,
+        const float world_size_y );
+    void polygonsToSDF_grid(
+        const float2 vertices[],
+        const int32_t polygonSizes[],
+        const int32_t polygonCount,
+        float sdf_output[],
+        int32_t sdf_output_width,
+        int32_t sdf_output_height,
+        const float world_start_x,
+        const float world_start_y,
+        const float world_size_x,
+        const float world_size_y,
+        const int32_t cell_pixels );
+    void polygonsToSDF_tiles(
+        const float2 vertices[],
+        const int32_t polygonSizes[],
+        const int32_t polygonCount,
+        float sdf_output[],
+        int32_t sdf_output_width,
+        int32_t sdf_output_height,
+        const float world_start_x,
+        const float world_start_y,
+        const float world_size_x,
+        const float world_size_y,
+        const int32_t tile_pixels,
+        float tile_bounds[] );
+    int32_t polygonsToSDF_update(
+        const float2 vertices[],
+        const int32_t polygonSizes[],
+        const int32_t polygonCount,
+        const int32_t changed_vertices[],
+        const float2 changed_previous[],
+        const int32_t changed_count,
+        float sdf_output[],
+        int32_t sdf_output_width,
+        int32_t sdf_output_height,
+        const float world_start_x,
+        const float world_start_y,
+        const float world_size_x,
+        const float world_size_y,
+        const int32_t tile_pixels,
+        float tile_bounds[] );
 
     void synthLoop(
         const int32_t sample_rate,
@@ -56,4 +129,34 @@ namespace serial
 
     float fft_1024_extract_lowband( float fftDataIn[] );
     void fft_1024_unrolled( float data[] );
+
+    void nestedLaunchTree(
+        const int32_t depth,
+        const int32_t fanout,
+        const int32_t leaf_size,
+        float output[] );
+    void flatLaunch(
+        const int32_t task_count,
+        const int32_t leaf_size,
+        float output[] );
+
+    float rooflineRead( const float data[], const int32_t count, const int32_t passes );
+    void rooflineWrite( float data[], const int32_t count, const int32_t passes );
+    void rooflineCopy( float destination[], const float source[], const int32_t count, const int32_t passes );
+    float rooflineFMA( const int32_t iterations, const float seed );
+    float rooflineRead_tasks( const float data[], const int32_t count, const int32_t passes, const int32_t tasks );
+    void rooflineWrite_tasks( float data[], const int32_t count, const int32_t passes, const int32_t tasks );
+    void rooflineCopy_tasks( float destination[], const float source[], const int32_t count, const int32_t passes, const int32_t tasks );
+    float rooflineFMA_tasks( const int32_t iterations, const float seed, const int32_t tasks );
+
+    void shortVecChain(
+        const float xs[],
+        const float ys[],
+        const float zs[],
+        const float ws[],
+        float out[],
+        const int32_t count,
+        const int32_t function,
+        const int32_t width,
+        const int32_t mode );
 }
\ No newline at end of file
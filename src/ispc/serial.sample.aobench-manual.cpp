@@ -43,6 +43,7 @@
 #endif
 
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 
 namespace serial_manual {
@@ -58,6 +59,48 @@ namespace serial_manual {
     }
 #endif // _MSC_VER
 
+    // the same per-subsample jitter as ao_sample_seed in rt.sample.aobench.ispc (rngScramble32 / rngFloat from
+    // common.random.inl.isph); only used to produce the output the variants are checked against
+    static inline uint32_t rngScramble32(const uint32_t value1)
+    {
+        uint32_t v1 = value1 * 0xcc9e2d51;
+        v1 = (v1 >> 17) | (v1 << (32 - 17));
+        v1 *= 0x1b873593;
+
+        uint32_t v2 = 0x85ebca6b ^ v1;
+        v2 = (v2 >> 19) | (v2 << (32 - 19));
+
+        return v2 * 5 + 0xe6546b64;
+    }
+
+    static inline float rngFloat(const uint32_t rng) { return (float)((double)rng * (1.0 / 4294967295.0)); }
+
+    // source of the occlusion ray jitter; the timed row runs the original's drand48 stream, seeded from y0
+    struct Drand48Jitter
+    {
+        explicit Drand48Jitter(int y0) { srand48(y0); }
+
+        void beginSample(int, int, int, int, int, int) {}
+        double next() { return drand48(); }
+    };
+
+    struct SeededJitter
+    {
+        explicit SeededJitter(int) {}
+
+        void beginSample(int x, int y, int u, int v, int w, int nsubsamples)
+        {
+            seed = rngScramble32((uint32_t)((((y * w) + x) * nsubsamples + u) * nsubsamples + v));
+        }
+        double next()
+        {
+            seed = rngScramble32(seed);
+            return rngFloat(seed);
+        }
+
+        uint32_t seed = 0;
+    };
+
 #ifdef _MSC_VER
     __declspec(align(16))
 #endif
@@ -202,7 +245,8 @@ namespace serial_manual {
         vnormalize(basis[1]);
     }
 
-    static float ambient_occlusion(Isect& isect, Plane& plane, Sphere spheres[4])
+    template <typename _Jitter>
+    static float ambient_occlusion(Isect& isect, Plane& plane, Sphere spheres[4], _Jitter& jitter)
     {
         float eps = 0.0001f;
         vec p, n;
@@ -220,8 +264,8 @@ namespace serial_manual {
                 Ray ray;
                 Isect occIsect;
 
-                float theta = sqrtf(drand48());
-                float phi = 2.0f * M_PI * drand48();
+                float theta = sqrtf(jitter.next());
+                float phi = 2.0f * M_PI * jitter.next();
                 float x = cosf(phi) * theta;
                 float y = sinf(phi) * theta;
                 float z = sqrtf(1.0f - theta * theta);
@@ -255,6 +299,7 @@ namespace serial_manual {
     /* Compute the image for the scanlines from [y0,y1), for an overall image
        of width w and height h.
      */
+    template <typename _Jitter>
     static void ao_scanlines( const int y0, const int y1, const int w, const int h, const int nsubsamples, float image[])
     {
         static Plane plane = { vec(0.0f, -0.5f, 0.0f), vec(0.f, 1.f, 0.f) };
@@ -265,7 +310,7 @@ namespace serial_manual {
             {vec(-1.5f, -0.4f, -1.6f), 0.3f}
         };
 
-        srand48(y0);
+        _Jitter jitter(y0);
 
         for (int y = y0; y < y1; ++y) {
             for (int x = 0; x < w; ++x) {
@@ -298,7 +343,8 @@ namespace serial_manual {
 
                         if (isect.hit)
                         {
-                            float ret = ambient_occlusion(isect, plane, spheres);
+                            jitter.beginSample(x, y, u, v, w, nsubsamples);
+                            float ret = ambient_occlusion(isect, plane, spheres, jitter);
 
                             // Update image for AO for this ray
                             image[offset] += ret;
@@ -317,6 +363,11 @@ namespace serial
 {
     void renderImageAmbientOcclusion_ManuallyPorted( const int w, const int h, const int nsubsamples, float* image )
     {
-        serial_manual::ao_scanlines(0, h, w, h, nsubsamples, image);
+        serial_manual::ao_scanlines<serial_manual::Drand48Jitter>(0, h, w, h, nsubsamples, image);
+    }
+
+    void renderImageAmbientOcclusion_ManuallyPorted_seeded( const int w, const int h, const int nsubsamples, float* image )
+    {
+        serial_manual::ao_scanlines<serial_manual::SeededJitter>(0, h, w, h, nsubsamples, image);
     }
 } // namespace serial
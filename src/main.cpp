@@ -9,11 +9,17 @@
 #include <cfloat>
 #include <cassert>
 #include <algorithm>
+#include <map>
+#include <thread>
 
 // ispc & serial function declarations
 #include "ispc/rt.exports.h"
+#include "ispc/rt.dispatch.h"
 #include "ispc/serial.exports.h"
 
+// runtime control of the task system used by ispc launch/sync
+#include "tasksys.h"
+
 // benchmarking
 #define PICOBENCH_IMPLEMENT
 #include "picobench/pico.h"
@@ -27,8 +33,87 @@
 #define TETHER_BENCHMARK_CLOUDS
 #define TETHER_BENCHMARK_AO
 #define TETHER_BENCHMARK_NOISE
+#define TETHER_BENCHMARK_NOISE_BATCH
+#define TETHER_BENCHMARK_APPROX
+#define TETHER_BENCHMARK_SHORTVEC
 #define TETHER_BENCHMARK_SYNTH
 #define TETHER_BENCHMARK_FFT
+#define TETHER_BENCHMARK_TASKS
+#define TETHER_BENCHMARK_ROOFLINE
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// output checking; rows compare what they produce against the auto-serial build of the same code, reported as PSNR and
+// max error columns and failing the run if they stray past the suite's limits. the serial output is made once per
+// dimension, outside of any timing, either by the serial row or by the first row that needs it
+
+namespace oracle {
+
+enum class Output
+{
+    Checked,        // compare against the reference and report the result as the row's accuracy
+    Reference,      // the row is the reference; keep its output for the others to compare against
+};
+
+template < typename _T >
+class Reference
+{
+public:
+
+    // reference output at this dimension, calling generate( std::vector<_T>& ) to produce it the first time
+    template < typename _generate >
+    const std::vector<_T>& get( const int dimension, const _generate& generate )
+    {
+        auto found = m_outputs.find( dimension );
+        if ( found == m_outputs.end() )
+        {
+            found = m_outputs.emplace( dimension, std::vector<_T>() ).first;
+            generate( found->second );
+        }
+        return found->second;
+    }
+
+    void store( const int dimension, const _T* output, const size_t count )
+    {
+        m_outputs[dimension].assign( output, output + count );
+    }
+
+private:
+    std::map< int, std::vector<_T> >  m_outputs;
+};
+
+// called by a row on one of its samples with the output it produced; a Checked row is compared against the reference
+// for the current dimension, failing below minPSNR (dB) or, if given, above maxAbsError. generate is only called if
+// nothing has stored the reference yet
+template < typename _T, typename _generate >
+inline void check(
+    picobench::state&   s,
+    Reference<_T>&      reference,
+    const Output        output,
+    const _T*           data,
+    const size_t        count,
+    const _generate&    generate,
+    const double        minPSNR,
+    const double        maxAbsError = 0.0 )
+{
+    if ( output == Output::Reference )
+    {
+        reference.store( s.iterations(), data, count );
+        return;
+    }
+
+    const utils::OutputError error = utils::compareOutput( data, reference.get( s.iterations(), generate ).data(), count );
+
+    picobench::accuracy_t accuracy;
+    accuracy.valid         = true;
+    accuracy.max_abs_error = error.maxAbsError;
+    accuracy.psnr          = error.psnr;
+    accuracy.min_psnr      = minPSNR;
+    accuracy.max_abs_limit = maxAbsError;
+    s.set_accuracy( accuracy );
+}
+
+} // namespace oracle
 
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -40,9 +125,32 @@ enum sdf
 {
     BenchmarkSamples    = 4,
     RenderWidth         = 1920,
-    RenderHeight        = 1920
+    RenderHeight        = 1920,
+    EdgeFlops           = 20,   // rough count of the distance and winding arithmetic for one pixel against one edge
 };
 
+// vertices in the outline and then its hole, in SDF_POLYDATA order
+static const std::array<int32_t, 2> sdf_polygonSizes { 66, 8 };
+
+// the sample-sdf dimension is how many of those polygons are walked; --suite-iters can ask for any number, so keep it
+// to the ones there are
+static uint32_t sdf_polygonsWalked( const int dimension )
+{
+    return (uint32_t)std::min( std::max( dimension, 1 ), (int)sdf_polygonSizes.size() );
+}
+
+// pixels written; flops assume every pixel is tested against every edge, as polygonsToSDF does
+static picobench::work_units sdf_benchmark_work( int dimension )
+{
+    const double pixels = (double)sdf::RenderWidth * (double)sdf::RenderHeight;
+
+    double edges = 0.0;
+    for ( uint32_t i = 0; i < sdf_polygonsWalked( dimension ); i++ )
+        edges += (double)sdf_polygonSizes[i];
+
+    return { pixels, "pix", pixels * edges * sdf::EdgeFlops, pixels * sizeof( float ) };
+}
+
 #define SDF_POLYDATA(_ty)       \
             _ty{ -0.19f, 3.15f },   \
             _ty{ -0.45f, 3.35f },   \
@@ -121,13 +229,42 @@ enum sdf
             _ty{ -0.76f, -1.58f }, 
 
 
+// distances only differ by float rounding between ISPC and serial
+static const double sdf_accuracy_min_psnr = 60.0;
+static oracle::Reference< float > sdf_reference;
+
+// the serial brute force polygonsToSDF over the whole render area, as the reference for the variants that take short
+// cuts; it tests every pixel against every edge, so it is split into bands of rows run on every core
+static void sdfBruteForceReference( const float2* vertices, const int32_t* polygonSizes, const int32_t polygonCount, std::vector<float>& reference )
+{
+    reference.resize( sdf::RenderWidth * sdf::RenderHeight );
+
+    const float   rangeY    = 16.0f / (float)sdf::RenderHeight;
+    const int32_t bandCount = (int32_t)std::max( std::thread::hardware_concurrency(), 1u );
+    const int32_t bandRows  = ( sdf::RenderHeight + bandCount - 1 ) / bandCount;
+
+    std::vector< std::thread > bands;
+    for ( int32_t y0 = 0; y0 < sdf::RenderHeight; y0 += bandRows )
+    {
+        const int32_t rows = std::min( bandRows, sdf::RenderHeight - y0 );
+
+        bands.emplace_back( [=, &reference]()
+        {
+            serial::polygonsToSDF( vertices, polygonSizes, polygonCount, reference.data() + ( y0 * sdf::RenderWidth ), sdf::RenderWidth, rows, -8.0f, -8.0f + ( (float)y0 * rangeY ), 16.0f, (float)rows * rangeY );
+        });
+    }
+    for ( auto& band : bands )
+        band.join();
+}
+
 // stub function that takes the actual call to execute for profiling; one sample run will write out the result as a PNG
+// and check it against the serial output
 template < typename _float2type, typename _dispatch >
-inline void indirectRenderSDF( picobench::state& s, const char* hostFunctionName, const _float2type c_vertices, const _dispatch& dispatch )
+inline void indirectRenderSDF( picobench::state& s, const char* hostFunctionName, const _float2type c_vertices, const _dispatch& dispatch, const oracle::Output output = oracle::Output::Checked )
 {
-    const uint32_t polysWalked = (uint32_t)s.iterations();
+    const uint32_t polysWalked = sdf_polygonsWalked( s.iterations() );
 
-    alignas(16) const std::array<int32_t, 2> c_poly { 66, 8 };
+    alignas(16) const std::array<int32_t, 2> c_poly = sdf_polygonSizes;
 
     container::AlignedFloatBuffer floatBuffer( sdf::RenderWidth * sdf::RenderHeight, 0.0f );
     {
@@ -137,9 +274,17 @@ inline void indirectRenderSDF( picobench::state& s, const char* hostFunctionName
 
     if ( s.sampleIndex() == 0 )
     {
+        oracle::check( s, sdf_reference, output, floatBuffer.data(), floatBuffer.numElements(), [&]( std::vector<float>& reference )
+        {
+            alignas(16) const std::array< float2, 74 > c_serialVertices { SDF_POLYDATA( float2 ) };
+
+            reference.resize( sdf::RenderWidth * sdf::RenderHeight );
+            serial::polygonsToSDF( c_serialVertices.data(), c_poly.data(), polysWalked, reference.data(), sdf::RenderWidth, sdf::RenderHeight, -8.0f, -8.0f, 16.0f, 16.0f );
+        }, sdf_accuracy_min_psnr );
+
         container::ImageBuffer imageOut( sdf::RenderWidth, sdf::RenderHeight );
 
-        ispc::SDFToRGB( floatBuffer.data(), sdf::RenderWidth, sdf::RenderHeight, imageOut.data(), sdf::RenderWidth, 1.0f / 10.0f );
+        ispc_isa::SDFToRGB( floatBuffer.data(), sdf::RenderWidth, sdf::RenderHeight, imageOut.data(), sdf::RenderWidth, 1.0f / 10.0f );
 
         imageOut.saveToPNG( hostFunctionName, polysWalked );
     }
@@ -152,12 +297,28 @@ static void sample_sdf_ispc( picobench::state& s )
 
     alignas(16) const std::array< ispc::float2, 74 > c_vertices { SDF_POLYDATA(ispc::float2) };
 
-    indirectRenderSDF( s, __FUNCTION__, c_vertices, ispc::polygonsToSDF );
+    indirectRenderSDF( s, __FUNCTION__, c_vertices, ispc_isa::polygonsToSDF );
 }
 PICOBENCH( sample_sdf_ispc )
         .label( "ispc" )
         .samples( sdf::BenchmarkSamples )
-        .iterations( {1, 2} );
+        .iterations( {1, 2} )
+        .work( sdf_benchmark_work );
+
+// ISPC variant compiled at half the gang width, see rt.sample.sdf.narrow.ispc
+static void sample_sdf_ispc_narrow( picobench::state& s )
+{
+    printf( "=" );
+
+    alignas(16) const std::array< ispc::float2, 74 > c_vertices { SDF_POLYDATA(ispc::float2) };
+
+    indirectRenderSDF( s, __FUNCTION__, c_vertices, ispc_isa::polygonsToSDF_narrow );
+}
+PICOBENCH( sample_sdf_ispc_narrow )
+        .label( "ispc_half_width" )
+        .samples( sdf::BenchmarkSamples )
+        .iterations( {1, 2} )
+        .work( sdf_benchmark_work );
 
 
 // auto-serial variant
@@ -167,12 +328,314 @@ static void sample_sdf_serial( picobench::state& s )
 
     alignas(16) const std::array< float2, 74 > c_vertices { SDF_POLYDATA( float2 ) };
 
-    indirectRenderSDF( s, __FUNCTION__, c_vertices, serial::polygonsToSDF );
+    indirectRenderSDF( s, __FUNCTION__, c_vertices, serial::polygonsToSDF, oracle::Output::Reference );
 }
 PICOBENCH( sample_sdf_serial )
         .label( "serial" )
         .samples( sdf::BenchmarkSamples )
-        .iterations( {1, 2} );
+        .iterations( {1, 2} )
+        .work( sdf_benchmark_work );
+
+
+PICOBENCH_SUITE( "sample-sdf-dense" );
+namespace sample_sdf_dense {
+
+enum constants
+{
+    BenchmarkSamples    = 2,
+    GridCellPixels      = 16,   // acceleration grid cell size for polygonsToSDF_grid
+    HoleFraction        = 8,    // the hole gets 1/8th as many vertices as the outline
+};
+static const std::vector<int> benchmark_iterations{ 2560, 10240 }; // vertices in the outline polygon
+
+// pixels written; the grid and distance transform variants skip most of the edge tests so only get a pixel rate
+static picobench::work_units benchmark_work( int /*outlineVertices*/ )
+{
+    const double pixels = (double)sdf::RenderWidth * (double)sdf::RenderHeight;
+    return { pixels, "pix", 0.0, pixels * sizeof( float ) };
+}
+
+// ... and for brute force, every pixel against every edge of the outline and the hole
+static picobench::work_units brute_force_work( int outlineVertices )
+{
+    picobench::work_units work = benchmark_work( outlineVertices );
+    work.flops = work.items * (double)( outlineVertices + outlineVertices / constants::HoleFraction ) * sdf::EdgeFlops;
+    return work;
+}
+
+// every row is checked against the serial brute force field. the grid only skips edges that can't be nearest, so it
+// is held to the same bar as brute force; the distance transform measures to the rasterized shape and leaves out the
+// noise distortion polygonsToSDF adds (up to 1.5), so it only has to stay within that distortion plus two pixels
+static const double accuracy_min_psnr       = sdf_accuracy_min_psnr;
+static const double edt_accuracy_min_psnr   = 35.0;
+static const double edt_max_abs_error       = 1.5 + ( 2.0 * 16.0 / (double)sdf::RenderWidth );
+static oracle::Reference< float > reference;
+
+// a wobbly closed outline around [cx, cy], standing in for a detailed map coastline; holes are wound the other way
+template < typename _float2type >
+inline void appendOutline( std::vector< _float2type >& vertices, const int32_t count, const float cx, const float cy, const float radius, const float wobble, const bool reversed )
+{
+    for ( int32_t i = 0; i < count; i++ )
+    {
+        const float t = 6.28318531f * (float)( reversed ? ( count - 1 - i ) : i ) / (float)count;
+        const float r = radius * ( 1.0f + wobble * ( 0.6f * std::sin( 7.0f * t ) + 0.3f * std::sin( 31.0f * t + 1.3f ) + 0.1f * std::sin( 173.0f * t ) ) );
+
+        vertices.push_back( _float2type{ cx + r * std::cos( t ), cy + r * std::sin( t ) } );
+    }
+}
+
+// the outline and its hole, for the given outline vertex count
+template < typename _float2type >
+inline std::vector< _float2type > buildShape( const int32_t outlineVertices )
+{
+    std::vector< _float2type > vertices;
+    appendOutline( vertices, outlineVertices, 0.5f, 0.2f, 5.0f, 0.2f, false );
+    appendOutline( vertices, outlineVertices / constants::HoleFraction, -1.5f, -1.0f, 1.2f, 0.3f, true );
+    return vertices;
+}
+
+template < typename _float2type, typename _dispatch >
+inline void indirectRenderSDF( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch, const double minPSNR = accuracy_min_psnr, const double maxAbsError = 0.0 )
+{
+    const int32_t outlineVertices = s.iterations();
+
+    const std::vector< _float2type > vertices = buildShape< _float2type >( outlineVertices );
+
+    const std::array<int32_t, 2> polySizes { outlineVertices, outlineVertices / constants::HoleFraction };
+
+    container::AlignedFloatBuffer floatBuffer( sdf::RenderWidth * sdf::RenderHeight, 0.0f );
+    {
+        picobench::scope scope( s );
+        dispatch( vertices.data(), polySizes.data(), 2, floatBuffer.data(), sdf::RenderWidth, sdf::RenderHeight, -8.0f, -8.0f, 16.0f, 16.0f );
+    }
+
+    if ( s.sampleIndex() == 0 )
+    {
+        oracle::check( s, reference, oracle::Output::Checked, floatBuffer.data(), floatBuffer.numElements(), [&]( std::vector<float>& bruteForce )
+        {
+            const std::vector< float2 > serialVertices = buildShape< float2 >( outlineVertices );
+            sdfBruteForceReference( serialVertices.data(), polySizes.data(), 2, bruteForce );
+        }, minPSNR, maxAbsError );
+
+        container::ImageBuffer imageOut( sdf::RenderWidth, sdf::RenderHeight );
+
+        ispc_isa::SDFToRGB( floatBuffer.data(), sdf::RenderWidth, sdf::RenderHeight, imageOut.data(), sdf::RenderWidth, 1.0f / 10.0f );
+
+        imageOut.saveToPNG( hostFunctionName, outlineVertices );
+    }
+}
+
+} // namespace sample_sdf_dense
+
+// ISPC variant, brute force over every edge; the baseline
+static void sample_sdf_dense_ispc( picobench::state& s )
+{
+    printf( "=" );
+    sample_sdf_dense::indirectRenderSDF< ispc::float2 >( s, __FUNCTION__, ispc_isa::polygonsToSDF );
+}
+PICOBENCH( sample_sdf_dense_ispc )
+        .label( "ispc" )
+        .samples( sample_sdf_dense::constants::BenchmarkSamples )
+        .iterations( sample_sdf_dense::benchmark_iterations )
+        .work( sample_sdf_dense::brute_force_work );
+
+// ISPC variant, per-cell candidate edges
+static void sample_sdf_dense_ispc_grid( picobench::state& s )
+{
+    printf( "=" );
+    sample_sdf_dense::indirectRenderSDF< ispc::float2 >( s, __FUNCTION__, []( const ispc::float2* vertices, const int32_t* polygonSizes, const int32_t polygonCount, float* output,
+                                                                           const int32_t w, const int32_t h, const float wsx, const float wsy, const float wsw, const float wsh )
+    {
+        ispc_isa::polygonsToSDF_grid( vertices, polygonSizes, polygonCount, output, w, h, wsx, wsy, wsw, wsh, sample_sdf_dense::constants::GridCellPixels );
+    });
+}
+PICOBENCH( sample_sdf_dense_ispc_grid )
+        .label( "ispc_grid" )
+        .samples( sample_sdf_dense::constants::BenchmarkSamples )
+        .iterations( sample_sdf_dense::benchmark_iterations )
+        .work( sample_sdf_dense::benchmark_work );
+
+// auto-serial variant, per-cell candidate edges; serial brute force is left out as it takes minutes at this size
+static void sample_sdf_dense_serial_grid( picobench::state& s )
+{
+    printf( "-" );
+    sample_sdf_dense::indirectRenderSDF< float2 >( s, __FUNCTION__, []( const float2* vertices, const int32_t* polygonSizes, const int32_t polygonCount, float* output,
+                                                                     const int32_t w, const int32_t h, const float wsx, const float wsy, const float wsw, const float wsh )
+    {
+        serial::polygonsToSDF_grid( vertices, polygonSizes, polygonCount, output, w, h, wsx, wsy, wsw, wsh, sample_sdf_dense::constants::GridCellPixels );
+    });
+}
+PICOBENCH( sample_sdf_dense_serial_grid )
+        .label( "serial_grid" )
+        .samples( sample_sdf_dense::constants::BenchmarkSamples )
+        .iterations( sample_sdf_dense::benchmark_iterations )
+        .work( sample_sdf_dense::benchmark_work );
+
+// ISPC variant, rasterized coverage + exact distance transform; cost no longer depends on edge count
+static void sample_sdf_dense_ispc_edt( picobench::state& s )
+{
+    printf( "=" );
+    sample_sdf_dense::indirectRenderSDF< ispc::float2 >( s, __FUNCTION__, ispc_isa::polygonsToSDF_edt, sample_sdf_dense::edt_accuracy_min_psnr, sample_sdf_dense::edt_max_abs_error );
+}
+PICOBENCH( sample_sdf_dense_ispc_edt )
+        .label( "ispc_edt" )
+        .samples( sample_sdf_dense::constants::BenchmarkSamples )
+        .iterations( sample_sdf_dense::benchmark_iterations )
+        .work( sample_sdf_dense::benchmark_work );
+
+// auto-serial variant, rasterized coverage + exact distance transform
+static void sample_sdf_dense_serial_edt( picobench::state& s )
+{
+    printf( "-" );
+    sample_sdf_dense::indirectRenderSDF< float2 >( s, __FUNCTION__, serial::polygonsToSDF_edt, sample_sdf_dense::edt_accuracy_min_psnr, sample_sdf_dense::edt_max_abs_error );
+}
+PICOBENCH( sample_sdf_dense_serial_edt )
+        .label( "serial_edt" )
+        .samples( sample_sdf_dense::constants::BenchmarkSamples )
+        .iterations( sample_sdf_dense::benchmark_iterations )
+        .work( sample_sdf_dense::benchmark_work );
+
+
+PICOBENCH_SUITE( "sample-sdf-edit" );
+namespace sample_sdf_edit {
+
+enum constants
+{
+    BenchmarkSamples    = 2,
+    TilePixels          = 32,   // tile size for polygonsToSDF_tiles / polygonsToSDF_update
+    EditedVertices      = 3,    // run of neighbouring vertices dragged by each edit
+};
+static const std::vector<int> benchmark_iterations{ 4, 16 }; // edits applied per sample
+
+static picobench::work_units benchmark_work( int edits )
+{
+    return { (double)edits, "edit" };
+}
+
+// the ispc and serial vector types name their components differently
+inline ispc::float2 nudge( const ispc::float2& v, const float d ) { return ispc::float2{ v.v[0] + d, v.v[1] - d }; }
+inline float2 nudge( const float2& v, const float d ) { return float2{ v.x + d, v.y - d }; }
+
+// edit (e): drag a run of EditedVertices neighbouring vertices of the outline, recording which moved and from where
+template < typename _float2type >
+inline void applyEdit( std::vector< _float2type >& vertices, const int32_t outlineVertices, const int32_t e, int32_t* changed, _float2type* previous )
+{
+    const float distance = ( e & 1 ) ? -0.25f : 0.25f;
+
+    for ( int32_t i = 0; i < constants::EditedVertices; i++ )
+    {
+        changed[i]  = ( ( e * 7 ) + i ) % outlineVertices;
+        previous[i] = vertices[changed[i]];
+
+        vertices[changed[i]] = nudge( previous[i], distance );
+    }
+}
+
+// tiles are re-evaluated exactly as polygonsToSDF evaluates pixels, so the final field is checked against a brute force
+// rebuild of the edited shape at the same bar
+static oracle::Reference< float > reference;
+
+// drag a short run of vertices of the outline back and forth, one edit per iteration, keeping the field up to date
+// with (dispatch); the first sample writes out the final field, which should match a full rebuild of the edited shape
+template < typename _float2type, typename _initial, typename _dispatch >
+inline void indirectEditSDF( picobench::state& s, const char* hostFunctionName, const _initial& initial, const _dispatch& dispatch )
+{
+    const int32_t edits = s.iterations();
+
+    std::vector< _float2type > vertices { SDF_POLYDATA( _float2type ) };
+    const std::array<int32_t, 2> polySizes = sdf_polygonSizes;
+
+    const int32_t tilesX = ( sdf::RenderWidth  + constants::TilePixels - 1 ) / constants::TilePixels;
+    const int32_t tilesY = ( sdf::RenderHeight + constants::TilePixels - 1 ) / constants::TilePixels;
+
+    container::AlignedFloatBuffer floatBuffer( sdf::RenderWidth * sdf::RenderHeight, 0.0f );
+    std::vector< float > tileBounds( tilesX * tilesY * polySizes.size() );
+
+    initial( vertices.data(), polySizes.data(), 2, floatBuffer.data(), sdf::RenderWidth, sdf::RenderHeight, -8.0f, -8.0f, 16.0f, 16.0f, constants::TilePixels, tileBounds.data() );
+
+    std::array< int32_t, constants::EditedVertices >        changed;
+    std::array< _float2type, constants::EditedVertices >    previous;
+
+    int64_t tilesEvaluated = 0;
+    {
+        picobench::scope scope( s );
+
+        for ( int32_t e = 0; e < edits; e++ )
+        {
+            applyEdit( vertices, polySizes[0], e, changed.data(), previous.data() );
+
+            tilesEvaluated += dispatch( vertices.data(), polySizes.data(), 2, changed.data(), previous.data(), constants::EditedVertices,
+                floatBuffer.data(), sdf::RenderWidth, sdf::RenderHeight, -8.0f, -8.0f, 16.0f, 16.0f, constants::TilePixels, tileBounds.data() );
+        }
+    }
+
+    if ( s.sampleIndex() == 0 )
+    {
+        printf( "[%i of %i tiles per edit]", (int)( tilesEvaluated / edits ), tilesX * tilesY );
+
+        oracle::check( s, reference, oracle::Output::Checked, floatBuffer.data(), floatBuffer.numElements(), [&]( std::vector<float>& bruteForce )
+        {
+            std::vector< float2 > serialVertices { SDF_POLYDATA( float2 ) };
+            std::array< int32_t, constants::EditedVertices >    serialChanged;
+            std::array< float2, constants::EditedVertices >     serialPrevious;
+
+            for ( int32_t e = 0; e < edits; e++ )
+                applyEdit( serialVertices, polySizes[0], e, serialChanged.data(), serialPrevious.data() );
+
+            sdfBruteForceReference( serialVertices.data(), polySizes.data(), 2, bruteForce );
+        }, sdf_accuracy_min_psnr );
+
+        container::ImageBuffer imageOut( sdf::RenderWidth, sdf::RenderHeight );
+
+        ispc_isa::SDFToRGB( floatBuffer.data(), sdf::RenderWidth, sdf::RenderHeight, imageOut.data(), sdf::RenderWidth, 1.0f / 10.0f );
+
+        imageOut.saveToPNG( hostFunctionName, edits );
+    }
+}
+
+} // namespace sample_sdf_edit
+
+// ISPC variant, rebuilding the whole field after every edit; the baseline
+static void sample_sdf_edit_ispc_full( picobench::state& s )
+{
+    printf( "=" );
+    sample_sdf_edit::indirectEditSDF< ispc::float2 >( s, __FUNCTION__, ispc_isa::polygonsToSDF_tiles,
+        []( const ispc::float2* vertices, const int32_t* polygonSizes, const int32_t polygonCount, const int32_t*, const ispc::float2*, const int32_t,
+            float* output, const int32_t w, const int32_t h, const float wsx, const float wsy, const float wsw, const float wsh, const int32_t tilePixels, float* tileBounds )
+    {
+        ispc_isa::polygonsToSDF_tiles( vertices, polygonSizes, polygonCount, output, w, h, wsx, wsy, wsw, wsh, tilePixels, tileBounds );
+        return ( ( w + tilePixels - 1 ) / tilePixels ) * ( ( h + tilePixels - 1 ) / tilePixels );
+    });
+}
+PICOBENCH( sample_sdf_edit_ispc_full )
+        .label( "ispc_full" )
+        .samples( sample_sdf_edit::constants::BenchmarkSamples )
+        .iterations( sample_sdf_edit::benchmark_iterations )
+        .work( sample_sdf_edit::benchmark_work );
+
+// ISPC variant, re-evaluating only the tiles each edit can reach
+static void sample_sdf_edit_ispc_update( picobench::state& s )
+{
+    printf( "=" );
+    sample_sdf_edit::indirectEditSDF< ispc::float2 >( s, __FUNCTION__, ispc_isa::polygonsToSDF_tiles, ispc_isa::polygonsToSDF_update );
+}
+PICOBENCH( sample_sdf_edit_ispc_update )
+        .label( "ispc_update" )
+        .samples( sample_sdf_edit::constants::BenchmarkSamples )
+        .iterations( sample_sdf_edit::benchmark_iterations )
+        .work( sample_sdf_edit::benchmark_work );
+
+// auto-serial variant, re-evaluating only the tiles each edit can reach
+static void sample_sdf_edit_serial_update( picobench::state& s )
+{
+    printf( "-" );
+    sample_sdf_edit::indirectEditSDF< float2 >( s, __FUNCTION__, serial::polygonsToSDF_tiles, serial::polygonsToSDF_update );
+}
+PICOBENCH( sample_sdf_edit_serial_update )
+        .label( "serial_update" )
+        .samples( sample_sdf_edit::constants::BenchmarkSamples )
+        .iterations( sample_sdf_edit::benchmark_iterations )
+        .work( sample_sdf_edit::benchmark_work );
 
 #endif // TETHER_BENCHMARK_SDF
 
@@ -186,13 +649,26 @@ namespace sample_render_clouds {
 enum constants
 {
     BenchmarkSamples = 4,
+    TaskTileWidth    = 64,  // tile dimensions for the task-launched variant, each tile is one task
+    TaskTileHeight   = 16,
 };
 static const std::vector<int> benchmark_iterations{ 320, 640 }; // width of images to render out
 
+static picobench::work_units benchmark_work( int renderWidth )
+{
+    const double pixels = (double)renderWidth * (double)( renderWidth / 2 );
+    return { pixels, "pix", 0.0, pixels * sizeof( uint32_t ) };
+}
+
+// the raymarch accumulates a lot of noise lookups per pixel, so fast-math differences can move the odd pixel a little
+static const double accuracy_min_psnr = 40.0;
+static oracle::Reference< uint32_t > reference;
+
 
 // stub function that takes the actual call to execute for profiling; one sample run will write out the result as a PNG
+// and check it against the serial output
 template < typename _dispatch >
-inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch )
+inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch, const oracle::Output output = oracle::Output::Checked )
 {
     uint32_t renderWidth  = (uint32_t)s.iterations();
     uint32_t renderHeight = (uint32_t)s.iterations() / 2;
@@ -205,6 +681,12 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 
     if ( s.sampleIndex() == 0 )
     {
+        oracle::check( s, reference, output, imageOut.data(), renderWidth * renderHeight, [=]( std::vector<uint32_t>& serialOutput )
+        {
+            serialOutput.resize( renderWidth * renderHeight );
+            serial::renderImageClouds( renderWidth, renderHeight, serialOutput.data() );
+        }, accuracy_min_psnr );
+
         imageOut.saveToPNG( hostFunctionName, renderWidth );
     }
 }
@@ -215,25 +697,67 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 static void sample_clouds_ispc( picobench::state& s )
 {
     printf( "=" );
-    sample_render_clouds::executeIndirect( s, __FUNCTION__, ispc::renderImageClouds );
+    sample_render_clouds::executeIndirect( s, __FUNCTION__, ispc_isa::renderImageClouds );
 }
 PICOBENCH( sample_clouds_ispc )
         .label( "ispc" )
         .samples( sample_render_clouds::constants::BenchmarkSamples )
-        .iterations( sample_render_clouds::benchmark_iterations );
+        .iterations( sample_render_clouds::benchmark_iterations )
+        .work( sample_render_clouds::benchmark_work );
+
+// ISPC variant compiled at half the gang width, see rt.sample.clouds.narrow.ispc
+static void sample_clouds_ispc_narrow( picobench::state& s )
+{
+    printf( "=" );
+    sample_render_clouds::executeIndirect( s, __FUNCTION__, ispc_isa::renderImageClouds_narrow );
+}
+PICOBENCH( sample_clouds_ispc_narrow )
+        .label( "ispc_half_width" )
+        .samples( sample_render_clouds::constants::BenchmarkSamples )
+        .iterations( sample_render_clouds::benchmark_iterations )
+        .work( sample_render_clouds::benchmark_work );
+
+// ISPC variant with the fog's exp on the 1e-3 approximation, see rt.sample.clouds.approx.ispc
+static void sample_clouds_ispc_approx( picobench::state& s )
+{
+    printf( "=" );
+    sample_render_clouds::executeIndirect( s, __FUNCTION__, ispc_isa::renderImageClouds_approx );
+}
+PICOBENCH( sample_clouds_ispc_approx )
+        .label( "ispc_approx" )
+        .samples( sample_render_clouds::constants::BenchmarkSamples )
+        .iterations( sample_render_clouds::benchmark_iterations )
+        .work( sample_render_clouds::benchmark_work );
+
+// ISPC variant, split into tiles and launched across all cores via the task system
+static void sample_clouds_ispc_tasks( picobench::state& s )
+{
+    printf( "=" );
+    sample_render_clouds::executeIndirect( s, __FUNCTION__, []( const int32_t w, const int32_t h, uint32_t* output )
+    {
+        ispc_isa::renderImageClouds_tasks( w, h, output, sample_render_clouds::constants::TaskTileWidth, sample_render_clouds::constants::TaskTileHeight );
+    });
+}
+PICOBENCH( sample_clouds_ispc_tasks )
+        .label( "ispc_tasks" )
+        .samples( sample_render_clouds::constants::BenchmarkSamples )
+        .iterations( sample_render_clouds::benchmark_iterations )
+        .work( sample_render_clouds::benchmark_work )
+        .all_cores();
 
 // auto-serial variant
 static void sample_clouds_serial( picobench::state& s )
 {
     printf( "-" );
-    sample_render_clouds::executeIndirect( s, __FUNCTION__, serial::renderImageClouds );
+    sample_render_clouds::executeIndirect( s, __FUNCTION__, serial::renderImageClouds, oracle::Output::Reference );
 }
 PICOBENCH( sample_clouds_serial )
         .label( "serial" )
         .samples( sample_render_clouds::constants::BenchmarkSamples )
-        .iterations( sample_render_clouds::benchmark_iterations );
+        .iterations( sample_render_clouds::benchmark_iterations )
+        .work( sample_render_clouds::benchmark_work );
 
-#endif // TETHER_BENCHMARK_AO
+#endif // TETHER_BENCHMARK_CLOUDS
 
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -246,14 +770,31 @@ enum constants
 {
     BenchmarkSamples = 4,
     RenderWidth = 600,
-    RenderHeight = 320
+    RenderHeight = 320,
+    TaskTileWidth = 32,     // tile dimensions for the task-launched variant, each tile is one task
+    TaskTileHeight = 8,
 };
 static const std::vector<int> benchmark_iterations{ 1, 2, 4, 8 }; // range of subsample values to run across benchmarks
 
+// every pixel takes subsamples^2 camera rays; how many of those go on to cast occlusion rays depends on the scene
+static picobench::work_units benchmark_work( int subSamples )
+{
+    const double pixels = (double)constants::RenderWidth * (double)constants::RenderHeight;
+    return { pixels * (double)( subSamples * subSamples ), "ray", 0.0, pixels * sizeof( float ) };
+}
+
+
+// the timed rows jitter their occlusion rays from aobench's own streams, one per program instance (or drand48 in the
+// manual port), so no two variants trace the same rays. the check instead runs each variant's _seeded export, which
+// jitters from a seed per subsample; those images only differ where float rounding tips an occlusion ray from hit to miss
+static const double accuracy_min_psnr = 40.0;
+static oracle::Reference< float > reference;
+
 
 // stub function that takes the actual call to execute for profiling; one sample run will write out the result as a PNG
-template < typename _dispatch >
-inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch )
+// and check the output of the seeded call against the auto-serial one
+template < typename _dispatch, typename _seeded >
+inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch, const _seeded& seeded, const oracle::Output output = oracle::Output::Checked )
 {
     const uint32_t aoSubSamples = (uint32_t)s.iterations();
 
@@ -265,9 +806,18 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 
     if ( s.sampleIndex() == 0 )
     {
+        container::AlignedFloatBuffer seededBuffer( constants::RenderWidth * constants::RenderHeight, 0.0f );
+        seeded( constants::RenderWidth, constants::RenderHeight, aoSubSamples, seededBuffer.data() );
+
+        oracle::check( s, reference, output, seededBuffer.data(), seededBuffer.numElements(), [=]( std::vector<float>& serialOutput )
+        {
+            serialOutput.assign( constants::RenderWidth * constants::RenderHeight, 0.0f );
+            serial::renderImageAmbientOcclusion_seeded( constants::RenderWidth, constants::RenderHeight, aoSubSamples, serialOutput.data() );
+        }, accuracy_min_psnr );
+
         container::ImageBuffer imageOut( constants::RenderWidth, constants::RenderHeight );
 
-        ispc::float1ToRGB( floatBuffer.data(), constants::RenderWidth, constants::RenderHeight, imageOut.data(), constants::RenderWidth );
+        ispc_isa::float1ToRGB( floatBuffer.data(), constants::RenderWidth, constants::RenderHeight, imageOut.data(), constants::RenderWidth );
 
         imageOut.saveToPNG( hostFunctionName, aoSubSamples );
     }
@@ -279,34 +829,67 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 static void sample_aobench_ispc( picobench::state& s )
 {
     printf( "=" );
-    sample_render_ao::executeIndirect( s, __FUNCTION__, ispc::renderImageAmbientOcclusion );
+    sample_render_ao::executeIndirect( s, __FUNCTION__, ispc_isa::renderImageAmbientOcclusion, ispc_isa::renderImageAmbientOcclusion_seeded );
 }
 PICOBENCH( sample_aobench_ispc )
         .label( "ispc" )
         .samples( sample_render_ao::constants::BenchmarkSamples )
-        .iterations( sample_render_ao::benchmark_iterations );
+        .iterations( sample_render_ao::benchmark_iterations )
+        .work( sample_render_ao::benchmark_work );
+
+// ISPC variant compiled at half the gang width, see rt.sample.aobench.narrow.ispc
+static void sample_aobench_ispc_narrow( picobench::state& s )
+{
+    printf( "=" );
+    sample_render_ao::executeIndirect( s, __FUNCTION__, ispc_isa::renderImageAmbientOcclusion_narrow, ispc_isa::renderImageAmbientOcclusion_seeded_narrow );
+}
+PICOBENCH( sample_aobench_ispc_narrow )
+        .label( "ispc_half_width" )
+        .samples( sample_render_ao::constants::BenchmarkSamples )
+        .iterations( sample_render_ao::benchmark_iterations )
+        .work( sample_render_ao::benchmark_work );
+
+// ISPC variant, split into tiles and launched across all cores via the task system; accumulates without atomics.
+// it already jitters from a seed per subsample, so the check runs it again as it is
+static void sample_aobench_ispc_tasks( picobench::state& s )
+{
+    printf( "=" );
+    const auto tasks = []( const int32_t w, const int32_t h, const int32_t nsubsamples, float* image )
+    {
+        ispc_isa::renderImageAmbientOcclusion_tasks( w, h, nsubsamples, image, sample_render_ao::constants::TaskTileWidth, sample_render_ao::constants::TaskTileHeight );
+    };
+    sample_render_ao::executeIndirect( s, __FUNCTION__, tasks, tasks );
+}
+PICOBENCH( sample_aobench_ispc_tasks )
+        .label( "ispc_tasks" )
+        .samples( sample_render_ao::constants::BenchmarkSamples )
+        .iterations( sample_render_ao::benchmark_iterations )
+        .work( sample_render_ao::benchmark_work )
+        .all_cores();
 
 // auto-serial variant
 static void sample_aobench_serial( picobench::state& s )
 {
     printf( "-" );
-    sample_render_ao::executeIndirect( s, __FUNCTION__, serial::renderImageAmbientOcclusion );
+    sample_render_ao::executeIndirect( s, __FUNCTION__, serial::renderImageAmbientOcclusion, serial::renderImageAmbientOcclusion_seeded, oracle::Output::Reference );
 }
 PICOBENCH( sample_aobench_serial )
         .label( "serial" )
         .samples( sample_render_ao::constants::BenchmarkSamples )
-        .iterations( sample_render_ao::benchmark_iterations );
+        .iterations( sample_render_ao::benchmark_iterations )
+        .work( sample_render_ao::benchmark_work );
 
 // manually ported serial variant
 static void sample_aobench_serial_manual( picobench::state& s )
 {
     printf( "-" );
-    sample_render_ao::executeIndirect( s, __FUNCTION__, serial::renderImageAmbientOcclusion_ManuallyPorted );
+    sample_render_ao::executeIndirect( s, __FUNCTION__, serial::renderImageAmbientOcclusion_ManuallyPorted, serial::renderImageAmbientOcclusion_ManuallyPorted_seeded );
 }
 PICOBENCH( sample_aobench_serial_manual )
         .label( "serial_manual" )
         .samples( sample_render_ao::constants::BenchmarkSamples )
-        .iterations( sample_render_ao::benchmark_iterations );
+        .iterations( sample_render_ao::benchmark_iterations )
+        .work( sample_render_ao::benchmark_work );
 
 #endif // TETHER_BENCHMARK_AO
 
@@ -323,10 +906,20 @@ enum constants
 };
 static const std::vector<int> benchmark_iterations{ 720, 1920 }; // output resolutions
 
+static picobench::work_units benchmark_work( int renderWidth )
+{
+    const double pixels = (double)renderWidth * (double)(uint32_t)( (float)renderWidth * 0.5625f );
+    return { pixels, "pix", 0.0, pixels * sizeof( uint32_t ) };
+}
+
+static const double accuracy_min_psnr = 40.0;
+static oracle::Reference< uint32_t > reference;
+
 
 // stub function that takes the actual call to execute for profiling; one sample run will write out the result as a PNG
+// and check it against the serial output
 template < typename _dispatch >
-inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch )
+inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch, const oracle::Output output = oracle::Output::Checked )
 {
     const uint32_t renderWidth = (uint32_t)s.iterations();
     const uint32_t renderHeight = (uint32_t)((float)s.iterations() * 0.5625f);
@@ -339,6 +932,12 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 
     if ( s.sampleIndex() == 0 )
     {
+        oracle::check( s, reference, output, imageOut.data(), renderWidth * renderHeight, [=]( std::vector<uint32_t>& serialOutput )
+        {
+            serialOutput.resize( renderWidth * renderHeight );
+            serial::renderImageNoiseBall( renderWidth, renderHeight, serialOutput.data(), renderWidth );
+        }, accuracy_min_psnr );
+
         imageOut.saveToPNG( hostFunctionName, renderWidth );
     }
 }
@@ -349,57 +948,632 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 static void sample_noise_ispc( picobench::state& s )
 {
     printf( "=" );
-    sample_render_noise::executeIndirect( s, __FUNCTION__, ispc::renderImageNoiseBall );
+    sample_render_noise::executeIndirect( s, __FUNCTION__, ispc_isa::renderImageNoiseBall );
 }
 PICOBENCH( sample_noise_ispc )
         .label( "ispc" )
         .samples( sample_render_noise::constants::BenchmarkSamples )
-        .iterations( sample_render_noise::benchmark_iterations );
+        .iterations( sample_render_noise::benchmark_iterations )
+        .work( sample_render_noise::benchmark_work );
+
+// ISPC variant compiled at half the gang width, see rt.sample.noise.narrow.ispc
+static void sample_noise_ispc_narrow( picobench::state& s )
+{
+    printf( "=" );
+    sample_render_noise::executeIndirect( s, __FUNCTION__, ispc_isa::renderImageNoiseBall_narrow );
+}
+PICOBENCH( sample_noise_ispc_narrow )
+        .label( "ispc_half_width" )
+        .samples( sample_render_noise::constants::BenchmarkSamples )
+        .iterations( sample_render_noise::benchmark_iterations )
+        .work( sample_render_noise::benchmark_work );
 
 // auto-serial variant
 static void sample_noise_serial( picobench::state& s )
 {
     printf( "-" );
-    sample_render_noise::executeIndirect( s, __FUNCTION__, serial::renderImageNoiseBall );
+    sample_render_noise::executeIndirect( s, __FUNCTION__, serial::renderImageNoiseBall, oracle::Output::Reference );
 }
 PICOBENCH( sample_noise_serial )
         .label( "serial" )
         .samples( sample_render_noise::constants::BenchmarkSamples )
-        .iterations( sample_render_noise::benchmark_iterations );
+        .iterations( sample_render_noise::benchmark_iterations )
+        .work( sample_render_noise::benchmark_work );
 
 #endif // TETHER_BENCHMARK_NOISE
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-#ifdef TETHER_BENCHMARK_SYNTH
-PICOBENCH_SUITE( "sample-synth" );
-namespace sample_synth {
+#ifdef TETHER_BENCHMARK_NOISE_BATCH
+PICOBENCH_SUITE( "noise-batch" );
+namespace noise_batch {
 
 enum constants
 {
-    BenchmarkSamples        = 4,
-    SampleRate              = 48000,
-    FXBufferMaskableLength  = 0xFFFF,
+    BenchmarkSamples = 4,
 };
-static const std::vector<int> benchmark_iterations{ 1, 10, 30 }; // length of audio clips to generate
+static const std::vector<int> benchmark_iterations{ 16384, 262144, 4194304 }; // positions per call; the largest is written with streaming stores
 
-// stub function that takes the actual call to execute for profiling; one sample run will write out the result as a PNG
-template < typename _dispatch >
-inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch )
+// 3D positions in, one value out
+static picobench::work_units benchmark_work( int count )
 {
-    const uint32_t synthOutputLength = (uint32_t)s.iterations();
+    return { (double)count, "val", 0.0, (double)count * 4.0 * sizeof( float ) };
+}
 
-    // delay FX buffers
-    container::AlignedFloatBuffer fxBufferLeft(  constants::FXBufferMaskableLength, 0.0f );
-    container::AlignedFloatBuffer fxBufferRight( constants::FXBufferMaskableLength, 0.0f );
+// 2D positions in, one value out
+static picobench::work_units benchmark_work_2d( int count )
+{
+    return { (double)count, "val", 0.0, (double)count * 3.0 * sizeof( float ) };
+}
 
-    static constexpr size_t noteDataLength = 6;
-    alignas(16) const std::array<uint32_t, noteDataLength> noteData { 3, 5, 2, 7, 5, 8 }; // Note_# from common.audio.inl.isph
+// noise at the same positions only differs by float rounding between ISPC and serial
+static const double accuracy_min_psnr = 50.0;
+static oracle::Reference< float > perlin3D_reference;
+static oracle::Reference< float > cellular2D_reference;
+static oracle::Reference< float > noise_reference;
 
-    container::WaveData< container::WaveChannels::Stereo, constants::SampleRate > waveData( synthOutputLength );
+// the same scattered positions for every row, spread over a few dozen lattice cells in each axis
+struct Positions
+{
+    explicit Positions( const uint32_t count )
+        : xs( count, 0.0f )
+        , ys( count, 0.0f )
+        , zs( count, 0.0f )
     {
-        picobench::scope scope( s );
-
+        uint32_t rng = 0x9e3779b9;
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            rng = rng * 1664525u + 1013904223u; xs.data()[i] = (float)( rng >> 8 ) * ( 64.0f / 16777216.0f ) - 32.0f;
+            rng = rng * 1664525u + 1013904223u; ys.data()[i] = (float)( rng >> 8 ) * ( 64.0f / 16777216.0f ) - 32.0f;
+            rng = rng * 1664525u + 1013904223u; zs.data()[i] = (float)( rng >> 8 ) * ( 64.0f / 16777216.0f ) - 32.0f;
+        }
+    }
+
+    container::AlignedFloatBuffer xs, ys, zs;
+};
+
+// stub function that takes the batch call to profile, as ( xs, ys, zs, out, count ); one sample run is checked against
+// the serial output
+template < typename _dispatch, typename _serial >
+inline void executeIndirect( picobench::state& s, oracle::Reference<float>& reference, const _dispatch& dispatch, const _serial& serialDispatch, const oracle::Output output = oracle::Output::Checked )
+{
+    const int32_t count = s.iterations();
+
+    Positions positions( count );
+
+    container::AlignedFloatBuffer noiseOut( count, 0.0f );
+    {
+        picobench::scope scope( s );
+        dispatch( positions.xs.data(), positions.ys.data(), positions.zs.data(), noiseOut.data(), count );
+    }
+
+    if ( s.sampleIndex() == 0 )
+    {
+        oracle::check( s, reference, output, noiseOut.data(), count, [&]( std::vector<float>& serialOutput )
+        {
+            serialOutput.resize( count );
+            serialDispatch( positions.xs.data(), positions.ys.data(), positions.zs.data(), serialOutput.data(), count );
+        }, accuracy_min_psnr );
+    }
+}
+
+// cellular2D_batch with the ( xs, ys, zs, out, count ) shape of the others, ignoring zs
+static void ispcCellular2D( const float* xs, const float* ys, const float*, float* out, const int32_t count )
+{
+    ispc_isa::cellular2D_batch( xs, ys, out, count );
+}
+static void serialCellular2D( const float* xs, const float* ys, const float*, float* out, const int32_t count )
+{
+    serial::cellular2D_batch( xs, ys, out, count );
+}
+
+} // namespace noise_batch
+
+// ISPC variant
+static void noise_batch_perlin3D_ispc( picobench::state& s )
+{
+    printf( "=" );
+    noise_batch::executeIndirect( s, noise_batch::perlin3D_reference, ispc_isa::perlin3D_batch, serial::perlin3D_batch );
+}
+PICOBENCH( noise_batch_perlin3D_ispc )
+        .label( "perlin3D_ispc" )
+        .samples( noise_batch::constants::BenchmarkSamples )
+        .iterations( noise_batch::benchmark_iterations )
+        .work( noise_batch::benchmark_work );
+
+// auto-serial variant
+static void noise_batch_perlin3D_serial( picobench::state& s )
+{
+    printf( "-" );
+    noise_batch::executeIndirect( s, noise_batch::perlin3D_reference, serial::perlin3D_batch, serial::perlin3D_batch, oracle::Output::Reference );
+}
+PICOBENCH( noise_batch_perlin3D_serial )
+        .label( "perlin3D_serial" )
+        .samples( noise_batch::constants::BenchmarkSamples )
+        .iterations( noise_batch::benchmark_iterations )
+        .work( noise_batch::benchmark_work );
+
+// ISPC variant
+static void noise_batch_cellular2D_ispc( picobench::state& s )
+{
+    printf( "=" );
+    noise_batch::executeIndirect( s, noise_batch::cellular2D_reference, noise_batch::ispcCellular2D, noise_batch::serialCellular2D );
+}
+PICOBENCH( noise_batch_cellular2D_ispc )
+        .label( "cellular2D_ispc" )
+        .samples( noise_batch::constants::BenchmarkSamples )
+        .iterations( noise_batch::benchmark_iterations )
+        .work( noise_batch::benchmark_work_2d );
+
+// auto-serial variant
+static void noise_batch_cellular2D_serial( picobench::state& s )
+{
+    printf( "-" );
+    noise_batch::executeIndirect( s, noise_batch::cellular2D_reference, noise_batch::serialCellular2D, noise_batch::serialCellular2D, oracle::Output::Reference );
+}
+PICOBENCH( noise_batch_cellular2D_serial )
+        .label( "cellular2D_serial" )
+        .samples( noise_batch::constants::BenchmarkSamples )
+        .iterations( noise_batch::benchmark_iterations )
+        .work( noise_batch::benchmark_work_2d );
+
+// ISPC variant
+static void noise_batch_noise_ispc( picobench::state& s )
+{
+    printf( "=" );
+    noise_batch::executeIndirect( s, noise_batch::noise_reference, ispc_isa::noise_batch, serial::noise_batch );
+}
+PICOBENCH( noise_batch_noise_ispc )
+        .label( "noise_ispc" )
+        .samples( noise_batch::constants::BenchmarkSamples )
+        .iterations( noise_batch::benchmark_iterations )
+        .work( noise_batch::benchmark_work );
+
+// auto-serial variant
+static void noise_batch_noise_serial( picobench::state& s )
+{
+    printf( "-" );
+    noise_batch::executeIndirect( s, noise_batch::noise_reference, serial::noise_batch, serial::noise_batch, oracle::Output::Reference );
+}
+PICOBENCH( noise_batch_noise_serial )
+        .label( "noise_serial" )
+        .samples( noise_batch::constants::BenchmarkSamples )
+        .iterations( noise_batch::benchmark_iterations )
+        .work( noise_batch::benchmark_work );
+
+#endif // TETHER_BENCHMARK_NOISE_BATCH
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifdef TETHER_BENCHMARK_APPROX
+PICOBENCH_SUITE( "approx" );
+namespace approx {
+
+enum constants
+{
+    BenchmarkSamples    = 4,
+    ErrorTableSamples   = 1 << 20,  // inputs swept per function and tier for the error table
+};
+static const std::vector<int> benchmark_iterations{ 65536, 1048576 }; // values per call
+
+// the same as ApproxTier in common.approx.inl.isph
+enum Tier
+{
+    Tier_1e3    = 0,
+    Tier_1e5    = 1,
+    Tier_Full   = 2,
+    TierCount
+};
+static const char* tierNames[] = { "1e-3", "1e-5", "full" };
+
+// the ISPC build uses MathLibrary=Fast (premake.lua), so its stdlib tier is held to the same bar as the 1e-3 one
+static const double accuracy_min_psnr[TierCount] = { 50.0, 70.0, 50.0 };
+
+// every export as ( xs, ys, out, count, tier ); ys is only read by pow
+using BatchFn = void (*)( const float* xs, const float* ys, float* out, const int32_t count, const int32_t tier );
+
+// a function under test, the range its inputs are spread over and a double precision reference for the error table;
+// exp and pow are measured by relative error, the rest by absolute error
+struct Function
+{
+    const char* name;
+    float       lo, hi;
+    float       ylo, yhi;
+    bool        relative;
+    double      (*reference)( double x, double y );
+    BatchFn     ispc;
+    BatchFn     serial;
+};
+
+enum FunctionIndex
+{
+    Fn_Sin,
+    Fn_Cos,
+    Fn_Acos,
+    Fn_Atan,
+    Fn_Exp,
+    Fn_Pow,
+    FunctionCount
+};
+
+static const Function functions[FunctionCount] =
+{
+    { "sin",   -25.132741f, 25.132741f,  0.0f, 0.0f, false,
+        []( double x, double ) { return std::sin( x ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { ispc_isa::approxSin_batch( xs, out, count, tier ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { serial::approxSin_batch( xs, out, count, tier ); } },
+    { "cos",   -25.132741f, 25.132741f,  0.0f, 0.0f, false,
+        []( double x, double ) { return std::cos( x ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { ispc_isa::approxCos_batch( xs, out, count, tier ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { serial::approxCos_batch( xs, out, count, tier ); } },
+    { "acos",  -1.0f,       1.0f,        0.0f, 0.0f, false,
+        []( double x, double ) { return std::acos( x ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { ispc_isa::approxAcos_batch( xs, out, count, tier ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { serial::approxAcos_batch( xs, out, count, tier ); } },
+    { "atan",  -8.0f,       8.0f,        0.0f, 0.0f, false,
+        []( double x, double ) { return std::atan( x ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { ispc_isa::approxAtan_batch( xs, out, count, tier ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { serial::approxAtan_batch( xs, out, count, tier ); } },
+    { "exp",   -20.0f,      5.0f,        0.0f, 0.0f, true,
+        []( double x, double ) { return std::exp( x ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { ispc_isa::approxExp_batch( xs, out, count, tier ); },
+        []( const float* xs, const float*, float* out, const int32_t count, const int32_t tier ) { serial::approxExp_batch( xs, out, count, tier ); } },
+    { "pow",   0.01f,       10.0f,      -3.0f, 3.0f, true,
+        []( double x, double y ) { return std::pow( x, y ); },
+        []( const float* xs, const float* ys, float* out, const int32_t count, const int32_t tier ) { ispc_isa::approxPow_batch( xs, ys, out, count, tier ); },
+        []( const float* xs, const float* ys, float* out, const int32_t count, const int32_t tier ) { serial::approxPow_batch( xs, ys, out, count, tier ); } },
+};
+
+static oracle::Reference< float > references[FunctionCount];
+
+// xs evenly spaced over the function's range; ys over its second range in a scattered order, so pow sees every
+// combination of small and large base and exponent
+struct Inputs
+{
+    Inputs( const Function& fn, const uint32_t count )
+        : xs( count, 0.0f )
+        , ys( count, 0.0f )
+    {
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            xs.data()[i] = fn.lo  + ( fn.hi  - fn.lo  ) * ( (float)i / (float)( count - 1 ) );
+            ys.data()[i] = fn.ylo + ( fn.yhi - fn.ylo ) * ( (float)( ( i * 7919u ) % count ) / (float)( count - 1 ) );
+        }
+    }
+
+    container::AlignedFloatBuffer xs, ys;
+};
+
+// one value in, one out; pow reads a second input
+static picobench::work_units benchmark_work( int count )
+{
+    return { (double)count, "val", 0.0, (double)count * 2.0 * sizeof( float ) };
+}
+
+static picobench::work_units benchmark_work_pow( int count )
+{
+    return { (double)count, "val", 0.0, (double)count * 3.0 * sizeof( float ) };
+}
+
+// times one call of the function at the given tier; one sample run is checked against the serial stdlib output
+inline void execute( picobench::state& s, const FunctionIndex fnIndex, const Tier tier, const bool useSerial, const oracle::Output output = oracle::Output::Checked )
+{
+    const Function& fn    = functions[fnIndex];
+    const int32_t   count = s.iterations();
+
+    Inputs inputs( fn, count );
+
+    container::AlignedFloatBuffer approxOut( count, 0.0f );
+    {
+        picobench::scope scope( s );
+        ( useSerial ? fn.serial : fn.ispc )( inputs.xs.data(), inputs.ys.data(), approxOut.data(), count, tier );
+    }
+
+    if ( s.sampleIndex() == 0 )
+    {
+        oracle::check( s, references[fnIndex], output, approxOut.data(), count, [&]( std::vector<float>& serialOutput )
+        {
+            serialOutput.resize( count );
+            fn.serial( inputs.xs.data(), inputs.ys.data(), serialOutput.data(), count, Tier_Full );
+        }, accuracy_min_psnr[tier] );
+    }
+}
+
+// distance from the double precision result in units of the last place of the float nearest to it
+inline double ulpError( const float value, const double reference )
+{
+    const float  nearest = std::abs( (float)reference );
+    const double ulp     = ( nearest < FLT_MAX ) ? (double)( std::nextafter( nearest, FLT_MAX ) - nearest ) : 1.0;
+    return std::abs( (double)value - reference ) / ulp;
+}
+
+struct ErrorBounds
+{
+    double  maxAbs = 0.0;
+    double  maxRel = 0.0;
+    double  maxUlp = 0.0;
+};
+
+static ErrorBounds measureError( const Function& fn, const BatchFn batch, const Tier tier )
+{
+    Inputs inputs( fn, constants::ErrorTableSamples );
+
+    container::AlignedFloatBuffer approxOut( constants::ErrorTableSamples, 0.0f );
+    batch( inputs.xs.data(), inputs.ys.data(), approxOut.data(), constants::ErrorTableSamples, tier );
+
+    ErrorBounds bounds;
+    for ( uint32_t i = 0; i < constants::ErrorTableSamples; i++ )
+    {
+        const double reference = fn.reference( inputs.xs.data()[i], inputs.ys.data()[i] );
+        const double absError  = std::abs( (double)approxOut.data()[i] - reference );
+
+        bounds.maxAbs = std::max( bounds.maxAbs, absError );
+        if ( reference != 0.0 )
+            bounds.maxRel = std::max( bounds.maxRel, absError / std::abs( reference ) );
+        bounds.maxUlp = std::max( bounds.maxUlp, ulpError( approxOut.data()[i], reference ) );
+    }
+    return bounds;
+}
+
+// worst error of every function and tier over its range, for the ISPC and serial builds; the relative error column
+// is only given for the functions measured that way, as the others pass through zero. ULP error is measured against
+// the float nearest the true result, so abs-error functions show very large values close to their roots
+static void printErrorTable()
+{
+    printf( "\n==================================================================================================================\n" );
+    printf( "  approx error, %i inputs per row against double precision\n\n", (int)constants::ErrorTableSamples );
+    printf( "  function | tier |       range       |  ispc abs |  ispc rel |   ispc ulp | serial abs | serial rel | serial ulp\n" );
+    printf( "  ---------+------+-------------------+-----------+-----------+------------+------------+------------+-----------\n" );
+
+    for ( int32_t f = 0; f < FunctionCount; f++ )
+    {
+        const Function& fn = functions[f];
+        for ( int32_t t = 0; t < TierCount; t++ )
+        {
+            const ErrorBounds ispcBounds   = measureError( fn, fn.ispc, (Tier)t );
+            const ErrorBounds serialBounds = measureError( fn, fn.serial, (Tier)t );
+
+            printf( "  %-8s | %4s | %7.2f .. %-6.2f | %9.2e |", fn.name, tierNames[t], fn.lo, fn.hi, ispcBounds.maxAbs );
+            if ( fn.relative )
+                printf( " %9.2e |", ispcBounds.maxRel );
+            else
+                printf( "         - |" );
+            printf( " %10.3g | %10.2e |", ispcBounds.maxUlp, serialBounds.maxAbs );
+            if ( fn.relative )
+                printf( " %10.2e |", serialBounds.maxRel );
+            else
+                printf( "          - |" );
+            printf( " %10.3g\n", serialBounds.maxUlp );
+        }
+    }
+
+    printf( "==================================================================================================================\n" );
+}
+
+} // namespace approx
+
+// the 1e-3, 1e-5 and stdlib tiers of one function from ISPC, plus the stdlib tier from serial as the reference; rows
+// are registered with picobench directly as PICOBENCH() names its registration after __LINE__, which would collide
+// across the rows of one expansion
+#define APPROX_ROWS( _name, _fnIndex, _work )                                                             \
+    static void approx_##_name##_1e3_ispc( picobench::state& s )                                          \
+    {                                                                                                     \
+        printf( "=" );                                                                                    \
+        approx::execute( s, _fnIndex, approx::Tier_1e3, false );                                          \
+    }                                                                                                     \
+    static auto& approx_##_name##_1e3_ispc_row =                                                          \
+        picobench::global_registry::new_benchmark( #_name "_1e3_ispc", approx_##_name##_1e3_ispc )        \
+            .samples( approx::constants::BenchmarkSamples )                                               \
+            .iterations( approx::benchmark_iterations )                                                   \
+            .work( _work );                                                                               \
+    static void approx_##_name##_1e5_ispc( picobench::state& s )                                          \
+    {                                                                                                     \
+        printf( "=" );                                                                                    \
+        approx::execute( s, _fnIndex, approx::Tier_1e5, false );                                          \
+    }                                                                                                     \
+    static auto& approx_##_name##_1e5_ispc_row =                                                          \
+        picobench::global_registry::new_benchmark( #_name "_1e5_ispc", approx_##_name##_1e5_ispc )        \
+            .samples( approx::constants::BenchmarkSamples )                                               \
+            .iterations( approx::benchmark_iterations )                                                   \
+            .work( _work );                                                                               \
+    static void approx_##_name##_full_ispc( picobench::state& s )                                         \
+    {                                                                                                     \
+        printf( "=" );                                                                                    \
+        approx::execute( s, _fnIndex, approx::Tier_Full, false );                                         \
+    }                                                                                                     \
+    static auto& approx_##_name##_full_ispc_row =                                                         \
+        picobench::global_registry::new_benchmark( #_name "_full_ispc", approx_##_name##_full_ispc )      \
+            .samples( approx::constants::BenchmarkSamples )                                               \
+            .iterations( approx::benchmark_iterations )                                                   \
+            .work( _work );                                                                               \
+    static void approx_##_name##_full_serial( picobench::state& s )                                       \
+    {                                                                                                     \
+        printf( "-" );                                                                                    \
+        approx::execute( s, _fnIndex, approx::Tier_Full, true, oracle::Output::Reference );               \
+    }                                                                                                     \
+    static auto& approx_##_name##_full_serial_row =                                                       \
+        picobench::global_registry::new_benchmark( #_name "_full_serial", approx_##_name##_full_serial )  \
+            .samples( approx::constants::BenchmarkSamples )                                               \
+            .iterations( approx::benchmark_iterations )                                                   \
+            .work( _work );
+
+APPROX_ROWS( sin,  approx::Fn_Sin,  approx::benchmark_work )
+APPROX_ROWS( cos,  approx::Fn_Cos,  approx::benchmark_work )
+APPROX_ROWS( acos, approx::Fn_Acos, approx::benchmark_work )
+APPROX_ROWS( atan, approx::Fn_Atan, approx::benchmark_work )
+APPROX_ROWS( exp,  approx::Fn_Exp,  approx::benchmark_work )
+APPROX_ROWS( pow,  approx::Fn_Pow,  approx::benchmark_work_pow )
+
+#undef APPROX_ROWS
+
+#endif // TETHER_BENCHMARK_APPROX
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifdef TETHER_BENCHMARK_SHORTVEC
+PICOBENCH_SUITE( "shortvec" );
+namespace shortvec {
+
+enum constants
+{
+    BenchmarkSamples    = 4,
+    ElementCount        = 65536,    // vectors per call
+    Chain               = 8,        // function calls per vector, SHORTVEC_CHAIN in rt.sample.shortvec.ispc
+};
+static const std::vector<int> benchmark_iterations{ 2, 3, 4 }; // vector width; every row processes ElementCount
+
+// the same as the enums in rt.sample.shortvec.ispc
+enum Function
+{
+    Fn_Pow2     = 0,
+    Fn_Pow4     = 1,
+    Fn_Lerp     = 2,
+    FunctionCount
+};
+
+enum Mode
+{
+    Mode_UniformPerChannel  = 0,
+    Mode_UniformNative      = 1,
+    Mode_VaryingPerChannel  = 2,
+    Mode_VaryingNative      = 3
+};
+
+// every variant does the same arithmetic, so anything below this is a real difference rather than rounding
+static constexpr double accuracy_min_psnr = 80.0;
+
+static oracle::Reference< float > references[FunctionCount];
+
+// one array per component, each value in 0 .. 1
+struct Inputs
+{
+    Inputs()
+        : xs( constants::ElementCount, 0.0f )
+        , ys( constants::ElementCount, 0.0f )
+        , zs( constants::ElementCount, 0.0f )
+        , ws( constants::ElementCount, 0.0f )
+    {
+        for ( uint32_t i = 0; i < constants::ElementCount; i++ )
+        {
+            const float t = (float)i / (float)( constants::ElementCount - 1 );
+            xs.data()[i] = t;
+            ys.data()[i] = 1.0f - t;
+            zs.data()[i] = (float)( ( i * 7919u ) % constants::ElementCount ) / (float)( constants::ElementCount - 1 );
+            ws.data()[i] = 0.5f;
+        }
+    }
+
+    container::AlignedFloatBuffer xs, ys, zs, ws;
+};
+
+// width components read per vector, one sum written
+static picobench::work_units benchmark_work( int width )
+{
+    const double count = (double)constants::ElementCount * constants::Chain;
+    return { count, "call", 0.0, (double)constants::ElementCount * ( width + 1 ) * sizeof( float ) };
+}
+
+// times one pass over the inputs at the width given by the row's dimension; one sample run is checked against serial
+inline void execute( picobench::state& s, const Function function, const Mode mode, const bool useSerial, const oracle::Output output = oracle::Output::Checked )
+{
+    const int32_t width = s.iterations();
+
+    Inputs inputs;
+
+    container::AlignedFloatBuffer sums( constants::ElementCount, 0.0f );
+    {
+        picobench::scope scope( s );
+        if ( useSerial )
+            serial::shortVecChain( inputs.xs.data(), inputs.ys.data(), inputs.zs.data(), inputs.ws.data(), sums.data(), constants::ElementCount, function, width, mode );
+        else
+            ispc_isa::shortVecChain( inputs.xs.data(), inputs.ys.data(), inputs.zs.data(), inputs.ws.data(), sums.data(), constants::ElementCount, function, width, mode );
+    }
+
+    if ( s.sampleIndex() == 0 )
+    {
+        oracle::check( s, references[function], output, sums.data(), constants::ElementCount, [&]( std::vector<float>& serialOutput )
+        {
+            serialOutput.resize( constants::ElementCount );
+            serial::shortVecChain( inputs.xs.data(), inputs.ys.data(), inputs.zs.data(), inputs.ws.data(), serialOutput.data(), constants::ElementCount, function, width, Mode_VaryingNative );
+        }, accuracy_min_psnr );
+    }
+}
+
+} // namespace shortvec
+
+// per-channel and native versions of each function on uniform and varying vectors, then the serial reference; rows
+// are registered with picobench directly, as in the approx suite. run with --perf for instructions per row
+#define SHORTVEC_ROW( _name, _suffix, _fn, _mode, _serial, _output, _mark )                                \
+    static void shortvec_##_name##_##_suffix( picobench::state& s )                                        \
+    {                                                                                                      \
+        printf( _mark );                                                                                   \
+        shortvec::execute( s, _fn, _mode, _serial, _output );                                              \
+    }                                                                                                      \
+    static auto& shortvec_##_name##_##_suffix##_row =                                                      \
+        picobench::global_registry::new_benchmark( #_name "_" #_suffix, shortvec_##_name##_##_suffix )     \
+            .samples( shortvec::constants::BenchmarkSamples )                                              \
+            .iterations( shortvec::benchmark_iterations )                                                  \
+            .work( shortvec::benchmark_work );
+
+#define SHORTVEC_ROWS( _name, _fn )                                                                                                                 \
+    SHORTVEC_ROW( _name, uniform_perchannel_ispc,   _fn, shortvec::Mode_UniformPerChannel,  false, oracle::Output::Checked,   "=" )    \
+    SHORTVEC_ROW( _name, uniform_native_ispc,       _fn, shortvec::Mode_UniformNative,      false, oracle::Output::Checked,   "=" )    \
+    SHORTVEC_ROW( _name, varying_perchannel_ispc,   _fn, shortvec::Mode_VaryingPerChannel,  false, oracle::Output::Checked,   "=" )    \
+    SHORTVEC_ROW( _name, varying_native_ispc,       _fn, shortvec::Mode_VaryingNative,      false, oracle::Output::Checked,   "=" )    \
+    SHORTVEC_ROW( _name, perchannel_serial,         _fn, shortvec::Mode_VaryingPerChannel,  true,  oracle::Output::Checked,   "-" )    \
+    SHORTVEC_ROW( _name, native_serial,             _fn, shortvec::Mode_VaryingNative,      true,  oracle::Output::Reference, "-" )
+
+SHORTVEC_ROWS( pow2, shortvec::Fn_Pow2 )
+SHORTVEC_ROWS( pow4, shortvec::Fn_Pow4 )
+SHORTVEC_ROWS( lerp, shortvec::Fn_Lerp )
+
+#undef SHORTVEC_ROWS
+#undef SHORTVEC_ROW
+
+#endif // TETHER_BENCHMARK_SHORTVEC
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifdef TETHER_BENCHMARK_SYNTH
+PICOBENCH_SUITE( "sample-synth" );
+namespace sample_synth {
+
+enum constants
+{
+    BenchmarkSamples        = 4,
+    SampleRate              = 48000,
+    FXBufferMaskableLength  = 0xFFFF,
+};
+static const std::vector<int> benchmark_iterations{ 1, 10, 30 }; // length of audio clips to generate
+
+// stereo sample frames written
+static picobench::work_units benchmark_work( int seconds )
+{
+    const double frames = (double)seconds * (double)constants::SampleRate;
+    return { frames, "smp", 0.0, frames * 2 * sizeof( float ) };
+}
+
+static const double accuracy_min_psnr = 60.0;
+static oracle::Reference< float > reference;
+
+// stub function that takes the actual call to execute for profiling; one sample run will write out the result as a WAV
+// and check both channels against the serial output
+template < typename _dispatch >
+inline void executeIndirect( picobench::state& s, const char* hostFunctionName, const _dispatch& dispatch, const oracle::Output output = oracle::Output::Checked )
+{
+    const uint32_t synthOutputLength = (uint32_t)s.iterations();
+
+    // delay FX buffers
+    container::AlignedFloatBuffer fxBufferLeft(  constants::FXBufferMaskableLength, 0.0f );
+    container::AlignedFloatBuffer fxBufferRight( constants::FXBufferMaskableLength, 0.0f );
+
+    static constexpr size_t noteDataLength = 6;
+    alignas(16) const std::array<uint32_t, noteDataLength> noteData { 3, 5, 2, 7, 5, 8 }; // Note_# from common.audio.inl.isph
+
+    container::WaveData< container::WaveChannels::Stereo, constants::SampleRate > waveData( synthOutputLength );
+    {
+        picobench::scope scope( s );
+
         dispatch( 
             constants::SampleRate,
             synthOutputLength,
@@ -415,6 +1589,30 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 
     if ( s.sampleIndex() == 0 )
     {
+        // left channel followed by right
+        const uint32_t frames = waveData.sampleCount();
+        std::vector<float> stereo( waveData.sampleChannel( 0 ), waveData.sampleChannel( 0 ) + frames );
+        stereo.insert( stereo.end(), waveData.sampleChannel( 1 ), waveData.sampleChannel( 1 ) + frames );
+
+        oracle::check( s, reference, output, stereo.data(), stereo.size(), [&]( std::vector<float>& serialOutput )
+        {
+            container::AlignedFloatBuffer serialFxLeft(  constants::FXBufferMaskableLength, 0.0f );
+            container::AlignedFloatBuffer serialFxRight( constants::FXBufferMaskableLength, 0.0f );
+
+            serialOutput.resize( frames * 2 );
+            serial::synthLoop(
+                constants::SampleRate,
+                synthOutputLength,
+                0,
+                noteDataLength,
+                noteData.data(),
+                serialOutput.data(),
+                serialOutput.data() + frames,
+                constants::FXBufferMaskableLength,
+                serialFxLeft.data(),
+                serialFxRight.data() );
+        }, accuracy_min_psnr );
+
         waveData.saveToWAV( hostFunctionName, synthOutputLength );
     }
 }
@@ -424,23 +1622,49 @@ inline void executeIndirect( picobench::state& s, const char* hostFunctionName,
 static void sample_synth_ispc( picobench::state& s )
 {
     printf( "=" );
-    sample_synth::executeIndirect( s, __FUNCTION__, ispc::synthLoop );
+    sample_synth::executeIndirect( s, __FUNCTION__, ispc_isa::synthLoop );
 }
 PICOBENCH( sample_synth_ispc )
         .label( "ispc" )
         .samples( sample_synth::constants::BenchmarkSamples )
-        .iterations( sample_synth::benchmark_iterations );
+        .iterations( sample_synth::benchmark_iterations )
+        .work( sample_synth::benchmark_work );
+
+// ISPC variant compiled at half the gang width, see rt.sample.synth.narrow.ispc
+static void sample_synth_ispc_narrow( picobench::state& s )
+{
+    printf( "=" );
+    sample_synth::executeIndirect( s, __FUNCTION__, ispc_isa::synthLoop_narrow );
+}
+PICOBENCH( sample_synth_ispc_narrow )
+        .label( "ispc_half_width" )
+        .samples( sample_synth::constants::BenchmarkSamples )
+        .iterations( sample_synth::benchmark_iterations )
+        .work( sample_synth::benchmark_work );
+
+// ISPC variant with the oscillators on the 1e-5 approximations, see rt.sample.synth.approx.ispc
+static void sample_synth_ispc_approx( picobench::state& s )
+{
+    printf( "=" );
+    sample_synth::executeIndirect( s, __FUNCTION__, ispc_isa::synthLoop_approx );
+}
+PICOBENCH( sample_synth_ispc_approx )
+        .label( "ispc_approx" )
+        .samples( sample_synth::constants::BenchmarkSamples )
+        .iterations( sample_synth::benchmark_iterations )
+        .work( sample_synth::benchmark_work );
 
 // auto-serial variant
 static void sample_synth_serial( picobench::state& s )
 {
     printf( "-" );
-    sample_synth::executeIndirect( s, __FUNCTION__, serial::synthLoop );
+    sample_synth::executeIndirect( s, __FUNCTION__, serial::synthLoop, oracle::Output::Reference );
 }
 PICOBENCH( sample_synth_serial )
         .label( "serial" )
         .samples( sample_synth::constants::BenchmarkSamples )
-        .iterations( sample_synth::benchmark_iterations );
+        .iterations( sample_synth::benchmark_iterations )
+        .work( sample_synth::benchmark_work );
 
 #endif // TETHER_BENCHMARK_SYNTH
 
@@ -457,6 +1681,14 @@ enum constants
 };
 static const std::vector<int> benchmark_iterations{ 64, 6000, 12000, 24000 };
 
+// complex points transformed, using the usual 5 N log2(N) flop count for a radix-2 FFT; each block of interleaved
+// floats is read and written once
+static picobench::work_units benchmark_work( int fftBlocks )
+{
+    const double points = (double)fftBlocks * 1024.0;
+    return { points, "pt", points * 5.0 * 10.0, points * 2 * sizeof( float ) * 2 };
+}
+
 void populateBuffer( container::AlignedFloatBuffer& buffer )
 {
     float* fftBufferData = buffer.data();
@@ -469,6 +1701,27 @@ void populateBuffer( container::AlignedFloatBuffer& buffer )
     }
 }
 
+static const double accuracy_min_psnr = 60.0;
+static oracle::Reference< float > reference;
+
+// compare every transformed block against the auto-serial build; run on one sample
+inline void checkOutput( picobench::state& s, container::AlignedFloatBuffer& fftBuffer, const oracle::Output output = oracle::Output::Checked )
+{
+    if ( s.sampleIndex() != 0 )
+        return;
+
+    oracle::check( s, reference, output, fftBuffer.data(), fftBuffer.numElements(), [&]( std::vector<float>& serialOutput )
+    {
+        container::AlignedFloatBuffer serialBuffer( fftBuffer.numElements(), 0.0f );
+        populateBuffer( serialBuffer );
+
+        for ( uint32_t f = 0; f < serialBuffer.numElements() / 2048; f++ )
+            serial::fft_1024_unrolled( serialBuffer.data() + (f * 2048) );
+
+        serialOutput.assign( serialBuffer.data(), serialBuffer.data() + serialBuffer.numElements() );
+    }, accuracy_min_psnr );
+}
+
 } // namespace sample_fft
 
 // ISPC variant
@@ -487,11 +1740,13 @@ static void sample_fft_ispc( picobench::state& s )
         for ( uint32_t f = 0; f < fftBlocks; f++ )
         {
             float* dataBlock = fftBuffer.data() + (f * 2048);
-            ispc::fft_1024_unrolled( dataBlock );
-            fftBand0.data()[f] = ispc::fft_1024_extract_lowband( dataBlock );
+            ispc_isa::fft_1024_unrolled( dataBlock );
+            fftBand0.data()[f] = ispc_isa::fft_1024_extract_lowband( dataBlock );
         }
     }
 
+    sample_fft::checkOutput( s, fftBuffer );
+
     container::AlignedFloatBuffer fftCheck( fftBlocks * 2048, 0.0f );
     sample_fft::populateBuffer( fftCheck );
     {
@@ -523,7 +1778,37 @@ static void sample_fft_ispc( picobench::state& s )
 PICOBENCH( sample_fft_ispc )
         .label( "ispc" )
         .samples( sample_fft::constants::BenchmarkSamples )
-        .iterations( sample_fft::benchmark_iterations );
+        .iterations( sample_fft::benchmark_iterations )
+        .work( sample_fft::benchmark_work );
+
+// ISPC variant compiled at half the gang width, see rt.sample.fft.narrow.ispc
+static void sample_fft_ispc_narrow( picobench::state& s )
+{
+    printf( "=" );
+
+    const uint32_t fftBlocks = (uint32_t)s.iterations();
+
+    container::AlignedFloatBuffer fftBand0( fftBlocks, 0.0f );
+
+    container::AlignedFloatBuffer fftBuffer( fftBlocks * 2048, 0.0f );
+    sample_fft::populateBuffer( fftBuffer );
+    {
+        picobench::scope scope( s );
+        for ( uint32_t f = 0; f < fftBlocks; f++ )
+        {
+            float* dataBlock = fftBuffer.data() + (f * 2048);
+            ispc_isa::fft_1024_unrolled_narrow( dataBlock );
+            fftBand0.data()[f] = ispc_isa::fft_1024_extract_lowband_narrow( dataBlock );
+        }
+    }
+
+    sample_fft::checkOutput( s, fftBuffer );
+}
+PICOBENCH( sample_fft_ispc_narrow )
+        .label( "ispc_half_width" )
+        .samples( sample_fft::constants::BenchmarkSamples )
+        .iterations( sample_fft::benchmark_iterations )
+        .work( sample_fft::benchmark_work );
 
 // auto-serial variant
 static void sample_fft_serial( picobench::state& s )
@@ -545,11 +1830,14 @@ static void sample_fft_serial( picobench::state& s )
             fftBand0.data()[f] = serial::fft_1024_extract_lowband( dataBlock );
         }
     }
+
+    sample_fft::checkOutput( s, fftBuffer, oracle::Output::Reference );
 }
 PICOBENCH( sample_fft_serial )
         .label( "serial" )
         .samples( sample_fft::constants::BenchmarkSamples )
-        .iterations( sample_fft::benchmark_iterations );
+        .iterations( sample_fft::benchmark_iterations )
+        .work( sample_fft::benchmark_work );
 
 // qlib serial variant
 static void sample_fft_serial_qlib( picobench::state& s )
@@ -571,27 +1859,795 @@ static void sample_fft_serial_qlib( picobench::state& s )
             fftBand0.data()[f] = serial::fft_1024_extract_lowband( dataBlock );
         }
     }
+
+    sample_fft::checkOutput( s, fftBuffer );
 }
 PICOBENCH( sample_fft_serial_qlib )
         .label( "serial_qlib" )
         .samples( sample_fft::constants::BenchmarkSamples )
-        .iterations( sample_fft::benchmark_iterations );
+        .iterations( sample_fft::benchmark_iterations )
+        .work( sample_fft::benchmark_work );
 
 #endif // TETHER_BENCHMARK_FFT
 
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-int main( int argc, char** argv )
-{
-    printf( "Tether-ISPC\n" );
-    printf( "ishani.org 2020\n" );
+#ifdef TETHER_BENCHMARK_TASKS
+PICOBENCH_SUITE( "sample-tasks-nested" );
+namespace sample_tasks_nested {
 
-    printf( "--------------------------------------------\n" );
+enum constants
+{
+    BenchmarkSamples    = 4,
+    TreeFanout          = 8,
+    LeafSize            = 256,
+};
+static const std::vector<int> benchmark_iterations{ 2, 3, 4, 5 }; // depth of nested launches; leaves = fanout ^ depth
+
+inline uint32_t outputLength( const uint32_t treeDepth )
+{
+    uint32_t leaves = 1;
+    for ( uint32_t d = 0; d < treeDepth; d++ )
+        leaves *= constants::TreeFanout;
+
+    return leaves * constants::LeafSize;
+}
+
+// leaf elements written; the hashing is integer work so there is no flop count
+static picobench::work_units benchmark_work( int treeDepth )
+{
+    const double elements = (double)outputLength( (uint32_t)treeDepth );
+    return { elements, "elem", 0.0, elements * sizeof( float ) };
+}
+
+} // namespace sample_tasks_nested
+
+// ISPC variant, every interior node is a task that launches and syncs on its children
+static void sample_tasks_nested_ispc( picobench::state& s )
+{
+    printf( "=" );
+
+    const uint32_t treeDepth = (uint32_t)s.iterations();
+
+    container::AlignedFloatBuffer treeOutput( sample_tasks_nested::outputLength( treeDepth ), 0.0f );
+    {
+        picobench::scope scope( s );
+        ispc_isa::nestedLaunchTree( treeDepth, sample_tasks_nested::constants::TreeFanout, sample_tasks_nested::constants::LeafSize, treeOutput.data() );
+    }
+
+    // leaf results are exact integer hashes, so any missed, repeated or misplaced task shows up here
+    container::AlignedFloatBuffer treeCheck( sample_tasks_nested::outputLength( treeDepth ), -1.0f );
+    serial::nestedLaunchTree( treeDepth, sample_tasks_nested::constants::TreeFanout, sample_tasks_nested::constants::LeafSize, treeCheck.data() );
+
+    for ( uint32_t i = 0; i < treeOutput.numElements(); i++ )
+    {
+        if ( treeOutput.data()[i] != treeCheck.data()[i] )
+        {
+            printf( "\nISPC/C++ nested launch output diverged at %u => [%f] vs [%f]\n", i, treeOutput.data()[i], treeCheck.data()[i] );
+            break;
+        }
+    }
+}
+PICOBENCH( sample_tasks_nested_ispc )
+        .label( "ispc" )
+        .samples( sample_tasks_nested::constants::BenchmarkSamples )
+        .iterations( sample_tasks_nested::benchmark_iterations )
+        .work( sample_tasks_nested::benchmark_work )
+        .all_cores();
+
+// auto-serial variant, plain recursion
+static void sample_tasks_nested_serial( picobench::state& s )
+{
+    printf( "-" );
+
+    const uint32_t treeDepth = (uint32_t)s.iterations();
+
+    container::AlignedFloatBuffer treeOutput( sample_tasks_nested::outputLength( treeDepth ), 0.0f );
+    {
+        picobench::scope scope( s );
+        serial::nestedLaunchTree( treeDepth, sample_tasks_nested::constants::TreeFanout, sample_tasks_nested::constants::LeafSize, treeOutput.data() );
+    }
+}
+PICOBENCH( sample_tasks_nested_serial )
+        .label( "serial" )
+        .samples( sample_tasks_nested::constants::BenchmarkSamples )
+        .iterations( sample_tasks_nested::benchmark_iterations )
+        .work( sample_tasks_nested::benchmark_work );
+
+
+PICOBENCH_SUITE( "sample-tasks-flat" );
+namespace sample_tasks_flat {
+
+enum constants
+{
+    BenchmarkSamples    = 4,
+    LeafSize            = 4,
+    CoarseTaskCount     = 64,
+};
+static const std::vector<int> benchmark_iterations{ 4096, 65536, 262144, 1048576 }; // tasks in the launch
+
+static picobench::work_units benchmark_work( int taskCount )
+{
+    const double elements = (double)taskCount * (double)constants::LeafSize;
+    return { elements, "elem", 0.0, elements * sizeof( float ) };
+}
+
+} // namespace sample_tasks_flat
+
+// ISPC variant, one launch with a task per leaf
+static void sample_tasks_flat_ispc( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t taskCount = s.iterations();
+
+    container::AlignedFloatBuffer flatOutput( taskCount * sample_tasks_flat::constants::LeafSize, 0.0f );
+    {
+        picobench::scope scope( s );
+        ispc_isa::flatLaunch( taskCount, sample_tasks_flat::constants::LeafSize, flatOutput.data() );
+    }
+
+    container::AlignedFloatBuffer flatCheck( taskCount * sample_tasks_flat::constants::LeafSize, -1.0f );
+    serial::flatLaunch( taskCount, sample_tasks_flat::constants::LeafSize, flatCheck.data() );
+
+    for ( uint32_t i = 0; i < flatOutput.numElements(); i++ )
+    {
+        if ( flatOutput.data()[i] != flatCheck.data()[i] )
+        {
+            printf( "\nISPC/C++ flat launch output diverged at %u => [%f] vs [%f]\n", i, flatOutput.data()[i], flatCheck.data()[i] );
+            break;
+        }
+    }
+}
+PICOBENCH( sample_tasks_flat_ispc )
+        .label( "ispc" )
+        .samples( sample_tasks_flat::constants::BenchmarkSamples )
+        .iterations( sample_tasks_flat::benchmark_iterations )
+        .work( sample_tasks_flat::benchmark_work )
+        .all_cores();
+
+// ISPC variant, same output from a small fixed number of large tasks; the baseline for what the per-task cost is
+static void sample_tasks_flat_ispc_coarse( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t taskCount = s.iterations();
+    const int32_t coarseLeafSize = ( taskCount * sample_tasks_flat::constants::LeafSize ) / sample_tasks_flat::constants::CoarseTaskCount;
+
+    container::AlignedFloatBuffer flatOutput( taskCount * sample_tasks_flat::constants::LeafSize, 0.0f );
+    {
+        picobench::scope scope( s );
+        ispc_isa::flatLaunch( sample_tasks_flat::constants::CoarseTaskCount, coarseLeafSize, flatOutput.data() );
+    }
+}
+PICOBENCH( sample_tasks_flat_ispc_coarse )
+        .label( "ispc_coarse" )
+        .samples( sample_tasks_flat::constants::BenchmarkSamples )
+        .iterations( sample_tasks_flat::benchmark_iterations )
+        .work( sample_tasks_flat::benchmark_work )
+        .all_cores();
+
+// auto-serial variant
+static void sample_tasks_flat_serial( picobench::state& s )
+{
+    printf( "-" );
+
+    const int32_t taskCount = s.iterations();
+
+    container::AlignedFloatBuffer flatOutput( taskCount * sample_tasks_flat::constants::LeafSize, 0.0f );
+    {
+        picobench::scope scope( s );
+        serial::flatLaunch( taskCount, sample_tasks_flat::constants::LeafSize, flatOutput.data() );
+    }
+}
+PICOBENCH( sample_tasks_flat_serial )
+        .label( "serial" )
+        .samples( sample_tasks_flat::constants::BenchmarkSamples )
+        .iterations( sample_tasks_flat::benchmark_iterations )
+        .work( sample_tasks_flat::benchmark_work );
+
+#endif // TETHER_BENCHMARK_TASKS
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifdef TETHER_BENCHMARK_ROOFLINE
+PICOBENCH_SUITE( "roofline-bandwidth" );
+namespace roofline_bandwidth {
+
+enum constants
+{
+    BenchmarkSamples    = 4,
+    BytesPerSample      = 1 << 30,  // passes are repeated until at least this much has been streamed in a sample
+};
+// working set in KiB, sized to sit in L1, L2, L3 and main memory on current desktop and server parts; the copy splits
+// it between source and destination
+static const std::vector<int> benchmark_iterations{ 16, 256, 4096, 131072 };
+static const char* levelNames[] = { "L1", "L2", "L3", "DRAM" };
+
+inline int32_t passesFor( const int workingSetKiB )
+{
+    return std::max( 1, constants::BytesPerSample / ( workingSetKiB * 1024 ) );
+}
+
+// bytes read and/or written; write-allocate traffic isn't counted, as with STREAM
+static picobench::work_units benchmark_work( int workingSetKiB )
+{
+    const double bytes = (double)workingSetKiB * 1024.0 * (double)passesFor( workingSetKiB );
+    return { bytes / sizeof( float ), "flt", 0.0, bytes };
+}
+
+// the task-launched variants split the working set into one slice per hardware thread; each slice is a multiple of
+// 64 floats (four accumulators of the widest gang), so the set is rounded down to fit, or up to 64 floats per task
+inline int32_t taskCount()
+{
+    return (int32_t)std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+inline int32_t taskFloats( const int32_t floats )
+{
+    return std::max( 64, ( floats / taskCount() ) & ~63 ) * taskCount();
+}
+
+static picobench::work_units tasks_work( int workingSetKiB )
+{
+    const double bytes = (double)taskFloats( ( workingSetKiB * 1024 ) / sizeof( float ) ) * sizeof( float ) * (double)passesFor( workingSetKiB );
+    return { bytes / sizeof( float ), "flt", 0.0, bytes };
+}
+
+// the copy moves two buffers of half the working set
+static picobench::work_units tasks_copy_work( int workingSetKiB )
+{
+    const double bytes = (double)taskFloats( ( workingSetKiB * 1024 ) / sizeof( float ) / 2 ) * sizeof( float ) * 2.0 * (double)passesFor( workingSetKiB );
+    return { bytes / sizeof( float ), "flt", 0.0, bytes };
+}
+
+} // namespace roofline_bandwidth
+
+// ISPC read, summing the buffer; the baseline
+static void roofline_read_ispc( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t floats = ( s.iterations() * 1024 ) / sizeof( float );
+    const int32_t passes = roofline_bandwidth::passesFor( s.iterations() );
+
+    container::AlignedFloatBuffer buffer( floats, 1.0f );
+    {
+        picobench::scope scope( s );
+        s.set_result( (uintptr_t)ispc_isa::rooflineRead( buffer.data(), floats, passes ) );
+    }
+}
+PICOBENCH( roofline_read_ispc )
+        .label( "ispc_read" )
+        .samples( roofline_bandwidth::constants::BenchmarkSamples )
+        .iterations( roofline_bandwidth::benchmark_iterations )
+        .work( roofline_bandwidth::benchmark_work );
+
+// ISPC write, filling the buffer
+static void roofline_write_ispc( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t floats = ( s.iterations() * 1024 ) / sizeof( float );
+    const int32_t passes = roofline_bandwidth::passesFor( s.iterations() );
+
+    container::AlignedFloatBuffer buffer( floats, 1.0f );
+    {
+        picobench::scope scope( s );
+        ispc_isa::rooflineWrite( buffer.data(), floats, passes );
+    }
+}
+PICOBENCH( roofline_write_ispc )
+        .label( "ispc_write" )
+        .samples( roofline_bandwidth::constants::BenchmarkSamples )
+        .iterations( roofline_bandwidth::benchmark_iterations )
+        .work( roofline_bandwidth::benchmark_work );
+
+// ISPC copy, half the working set to the other half
+static void roofline_copy_ispc( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t floats = ( s.iterations() * 1024 ) / sizeof( float ) / 2;
+    const int32_t passes = roofline_bandwidth::passesFor( s.iterations() );
+
+    container::AlignedFloatBuffer source( floats, 1.0f );
+    container::AlignedFloatBuffer destination( floats, 0.0f );
+    {
+        picobench::scope scope( s );
+        ispc_isa::rooflineCopy( destination.data(), source.data(), floats, passes );
+    }
+}
+PICOBENCH( roofline_copy_ispc )
+        .label( "ispc_copy" )
+        .samples( roofline_bandwidth::constants::BenchmarkSamples )
+        .iterations( roofline_bandwidth::benchmark_iterations )
+        .work( roofline_bandwidth::benchmark_work );
+
+// auto-serial read
+static void roofline_read_serial( picobench::state& s )
+{
+    printf( "-" );
+
+    const int32_t floats = ( s.iterations() * 1024 ) / sizeof( float );
+    const int32_t passes = roofline_bandwidth::passesFor( s.iterations() );
+
+    container::AlignedFloatBuffer buffer( floats, 1.0f );
+    {
+        picobench::scope scope( s );
+        s.set_result( (uintptr_t)serial::rooflineRead( buffer.data(), floats, passes ) );
+    }
+}
+PICOBENCH( roofline_read_serial )
+        .label( "serial_read" )
+        .samples( roofline_bandwidth::constants::BenchmarkSamples )
+        .iterations( roofline_bandwidth::benchmark_iterations )
+        .work( roofline_bandwidth::benchmark_work );
+
+// ISPC read across every core; the machine's bandwidth, which the task-launched rows are placed against
+static void roofline_read_ispc_tasks( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t floats = roofline_bandwidth::taskFloats( ( s.iterations() * 1024 ) / sizeof( float ) );
+    const int32_t passes = roofline_bandwidth::passesFor( s.iterations() );
+
+    container::AlignedFloatBuffer buffer( floats, 1.0f );
+    {
+        picobench::scope scope( s );
+        s.set_result( (uintptr_t)ispc_isa::rooflineRead_tasks( buffer.data(), floats, passes, roofline_bandwidth::taskCount() ) );
+    }
+}
+PICOBENCH( roofline_read_ispc_tasks )
+        .label( "ispc_read_tasks" )
+        .samples( roofline_bandwidth::constants::BenchmarkSamples )
+        .iterations( roofline_bandwidth::benchmark_iterations )
+        .work( roofline_bandwidth::tasks_work )
+        .all_cores();
+
+// ISPC write across every core
+static void roofline_write_ispc_tasks( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t floats = roofline_bandwidth::taskFloats( ( s.iterations() * 1024 ) / sizeof( float ) );
+    const int32_t passes = roofline_bandwidth::passesFor( s.iterations() );
+
+    container::AlignedFloatBuffer buffer( floats, 1.0f );
+    {
+        picobench::scope scope( s );
+        ispc_isa::rooflineWrite_tasks( buffer.data(), floats, passes, roofline_bandwidth::taskCount() );
+    }
+}
+PICOBENCH( roofline_write_ispc_tasks )
+        .label( "ispc_write_tasks" )
+        .samples( roofline_bandwidth::constants::BenchmarkSamples )
+        .iterations( roofline_bandwidth::benchmark_iterations )
+        .work( roofline_bandwidth::tasks_work )
+        .all_cores();
+
+// ISPC copy across every core
+static void roofline_copy_ispc_tasks( picobench::state& s )
+{
+    printf( "=" );
+
+    const int32_t floats = roofline_bandwidth::taskFloats( ( s.iterations() * 1024 ) / sizeof( float ) / 2 );
+    const int32_t passes = roofline_bandwidth::passesFor( s.iterations() );
+
+    container::AlignedFloatBuffer source( floats, 1.0f );
+    container::AlignedFloatBuffer destination( floats, 0.0f );
+    {
+        picobench::scope scope( s );
+        ispc_isa::rooflineCopy_tasks( destination.data(), source.data(), floats, passes, roofline_bandwidth::taskCount() );
+    }
+}
+PICOBENCH( roofline_copy_ispc_tasks )
+        .label( "ispc_copy_tasks" )
+        .samples( roofline_bandwidth::constants::BenchmarkSamples )
+        .iterations( roofline_bandwidth::benchmark_iterations )
+        .work( roofline_bandwidth::tasks_copy_work )
+        .all_cores();
+
+
+PICOBENCH_SUITE( "roofline-compute" );
+namespace roofline_compute {
+
+enum constants
+{
+    BenchmarkSamples    = 4,
+    Chains              = 8,    // independent multiply-add chains per lane in rooflineFMA
+};
+static const std::vector<int> benchmark_iterations{ 1 << 20, 1 << 24 }; // multiply-add steps per chain
+
+static picobench::work_units ispc_work( int iterations )
+{
+    const double fmas = (double)iterations * constants::Chains * ispc_isa::targetWidth();
+    return { fmas, "fma", fmas * 2.0 };
+}
+
+static picobench::work_units serial_work( int iterations )
+{
+    const double fmas = (double)iterations * constants::Chains;
+    return { fmas, "fma", fmas * 2.0 };
+}
+
+// every task runs the full set of chains
+static picobench::work_units tasks_work( int iterations )
+{
+    const double fmas = (double)iterations * constants::Chains * ispc_isa::targetWidth() * roofline_bandwidth::taskCount();
+    return { fmas, "fma", fmas * 2.0 };
+}
+
+} // namespace roofline_compute
+
+// ISPC variant, one multiply-add chain per lane per register
+static void roofline_fma_ispc( picobench::state& s )
+{
+    printf( "=" );
+
+    picobench::scope scope( s );
+    s.set_result( (uintptr_t)ispc_isa::rooflineFMA( s.iterations(), 1.0f ) );
+}
+PICOBENCH( roofline_fma_ispc )
+        .label( "ispc_fma" )
+        .samples( roofline_compute::constants::BenchmarkSamples )
+        .iterations( roofline_compute::benchmark_iterations )
+        .work( roofline_compute::ispc_work );
+
+// auto-serial variant
+static void roofline_fma_serial( picobench::state& s )
+{
+    printf( "-" );
+
+    picobench::scope scope( s );
+    s.set_result( (uintptr_t)serial::rooflineFMA( s.iterations(), 1.0f ) );
+}
+PICOBENCH( roofline_fma_serial )
+        .label( "serial_fma" )
+        .samples( roofline_compute::constants::BenchmarkSamples )
+        .iterations( roofline_compute::benchmark_iterations )
+        .work( roofline_compute::serial_work );
+
+// ISPC variant on every core; the machine's peak, which the task-launched rows are placed against
+static void roofline_fma_ispc_tasks( picobench::state& s )
+{
+    printf( "=" );
+
+    picobench::scope scope( s );
+    s.set_result( (uintptr_t)ispc_isa::rooflineFMA_tasks( s.iterations(), 1.0f, roofline_bandwidth::taskCount() ) );
+}
+PICOBENCH( roofline_fma_ispc_tasks )
+        .label( "ispc_fma_tasks" )
+        .samples( roofline_compute::constants::BenchmarkSamples )
+        .iterations( roofline_compute::benchmark_iterations )
+        .work( roofline_compute::tasks_work )
+        .all_cores();
+
+
+namespace roofline {
+
+// the fastest rate the benchmarks of a suite reached at each dimension in the report, counting only the rows that did
+// (or didn't) run across every core; work per nanosecond is the same as billions per second
+static std::map< int, double > suitePeaks( const picobench::report& rpt, const char* suiteName, const bool allCores, const bool flops )
+{
+    std::map< int, double > peaks;
+
+    const picobench::report::suite* suite = rpt.find_suite( suiteName );
+    if ( suite == nullptr )
+        return peaks;
+
+    for ( const auto& bm : suite->benchmarks )
+    {
+        if ( bm.all_cores != allCores )
+            continue;
+
+        for ( const auto& d : bm.data )
+        {
+            if ( d.total_time_ns > 0 )
+                peaks[d.dimension] = std::max( peaks[d.dimension], ( flops ? d.work.flops : d.work.bytes ) / (double)d.total_time_ns );
+        }
+    }
+    return peaks;
+}
+
+// the ceilings of one thread, or of the whole machine from the task-launched roofline rows; bandwidth is taken at
+// whichever working sets the roofline-bandwidth suite ran (--suite-iters can change them), and the largest of those
+// stands for main memory
+struct Roofs
+{
+    explicit Roofs( const picobench::report& rpt, const bool _allCores )
+        : allCores( _allCores )
+    {
+        for ( const auto& peak : suitePeaks( rpt, "roofline-compute", allCores, true ) )
+            peakFlops = std::max( peakFlops, peak.second );
+
+        bandwidth = suitePeaks( rpt, "roofline-bandwidth", allCores, false );
+    }
+
+    bool valid() const { return peakFlops > 0.0 && memoryBandwidth() > 0.0; }
+    double memoryBandwidth() const { return bandwidth.empty() ? 0.0 : bandwidth.rbegin()->second; }
+    double ridge() const { return peakFlops / memoryBandwidth(); }
+
+    bool                    allCores;
+    double                  peakFlops = 0.0;
+    std::map< int, double > bandwidth;  // working set in KiB => GB/s
+};
+
+// the cache level a working set was sized for, or its size if --suite-iters picked a different one
+static std::string levelName( const int workingSetKiB )
+{
+    for ( size_t level = 0; level < roofline_bandwidth::benchmark_iterations.size(); level++ )
+    {
+        if ( roofline_bandwidth::benchmark_iterations[level] == workingSetKiB )
+            return roofline_bandwidth::levelNames[level];
+    }
+    return utils::stringFormat( "%i KiB", workingSetKiB );
+}
+
+static const char* coresName( const bool allCores )
+{
+    return allCores ? "all" : "1";
+}
+
+static void printRoofs( const Roofs& roofs, FILE* csv )
+{
+    if ( roofs.allCores )
+        printf( "roofline, all cores (%i tasks): peak %.1f GFLOP/s;", roofline_bandwidth::taskCount(), roofs.peakFlops );
+    else
+        printf( "roofline, 1 core: peak %.1f GFLOP/s;", roofs.peakFlops );
+
+    const char* separator = " ";
+    for ( const auto& level : roofs.bandwidth )
+    {
+        printf( "%s%s %.1f", separator, levelName( level.first ).c_str(), level.second );
+        separator = ", ";
+    }
+    printf( " GB/s; ridge point %.2f FLOP/byte\n", roofs.ridge() );
+
+    if ( csv != nullptr )
+    {
+        fprintf( csv, "roofline,peak,0,,%.3f,,,,,%s\n", roofs.peakFlops, coresName( roofs.allCores ) );
+        for ( const auto& level : roofs.bandwidth )
+            fprintf( csv, "roofline,%s,%i,,,%.3f,,,,%s\n", levelName( level.first ).c_str(), level.first, level.second, coresName( roofs.allCores ) );
+    }
+}
+
+// where each benchmark row sits against the measured ceilings; single-threaded rows against the roofs of one thread,
+// rows marked all_cores() (the task-launched ones) against the roofs of the whole machine. rows that declared flops
+// and bytes are placed on the roofline using main memory bandwidth, rows with only bytes are compared to main memory
+// bandwidth alone
+static void printTable( const picobench::report& rpt, FILE* csv )
+{
+    const Roofs singleCore( rpt, false );
+    const Roofs allCores( rpt, true );
+
+    if ( !singleCore.valid() && !allCores.valid() )
+    {
+        printf( "\nroofline: no table, the roofline-compute and roofline-bandwidth suites have no results to take the roofs from\n" );
+        return;
+    }
+
+    printf( "\n" );
+    if ( csv != nullptr )
+        fprintf( csv, "Suite,Benchmark,D,\"FLOP/byte\",\"GFLOP/s\",\"GB/s\",\"Roof GFLOP/s\",\"%% roof\",Bound,Cores\n" );
+
+    if ( singleCore.valid() )
+        printRoofs( singleCore, csv );
+    else
+        printf( "roofline, 1 core: not measured, single-threaded rows are left out\n" );
+
+    if ( allCores.valid() )
+        printRoofs( allCores, csv );
+    else
+        printf( "roofline, all cores: not measured, task-launched rows are left out\n" );
+
+    printf( "==========================================================================================================================\n" );
+    printf( "  Suite                 |   Benchmark   |   Dim   | FLOP/byte | GFLOP/s |   GB/s  | Roof GFLOP/s | %% roof | Bound   | Cores\n" );
+    printf( "==========================================================================================================================\n" );
+
+    for ( const auto& suite : rpt.suites )
+    {
+        if ( strncmp( suite.name, "roofline-", 9 ) == 0 )
+            continue;
+
+        for ( const auto& bm : suite.benchmarks )
+        {
+            const Roofs& roofs = bm.all_cores ? allCores : singleCore;
+            if ( !roofs.valid() )
+                continue;
+
+            const double peakFlops          = roofs.peakFlops;
+            const double memoryBandwidth    = roofs.memoryBandwidth();
+            const double ridge              = roofs.ridge();
+
+            for ( const auto& d : bm.data )
+            {
+                if ( ( d.work.flops <= 0.0 && d.work.bytes <= 0.0 ) || d.total_time_ns <= 0 )
+                    continue;
+
+                const double gflops     = d.work.flops / (double)d.total_time_ns;
+                const double gbytes     = d.work.bytes / (double)d.total_time_ns;
+                const double intensity  = ( d.work.bytes > 0.0 ) ? d.work.flops / d.work.bytes : 0.0;
+
+                double      roof    = 0.0;
+                double      ofRoof  = 0.0;
+                const char* bound   = "-";
+                if ( d.work.flops > 0.0 )
+                {
+                    roof    = ( d.work.bytes > 0.0 ) ? std::min( peakFlops, intensity * memoryBandwidth ) : peakFlops;
+                    ofRoof  = gflops / roof;
+                    bound   = ( d.work.bytes > 0.0 && intensity < ridge ) ? "memory" : "compute";
+                }
+                else
+                {
+                    ofRoof  = gbytes / memoryBandwidth;
+                }
+
+                printf( "  %-21s | %13s | %7i |", suite.name, bm.name, d.dimension );
+                if ( intensity > 0.0 )
+                    printf( " %9.3f | %7.2f |", intensity, gflops );
+                else
+                    printf( "         - |       - |" );
+                printf( " %7.2f |", gbytes );
+                if ( roof > 0.0 )
+                    printf( " %12.2f |", roof );
+                else
+                    printf( "            - |" );
+                printf( " %5.1f%% | %-7s | %s\n", ofRoof * 100.0, bound, coresName( bm.all_cores ) );
+
+                if ( csv != nullptr )
+                {
+                    fprintf( csv, "\"%s\",\"%s\",%i,", suite.name, bm.name, d.dimension );
+                    if ( intensity > 0.0 )
+                        fprintf( csv, "%.4f,%.3f", intensity, gflops );
+                    else
+                        fprintf( csv, "," );
+                    fprintf( csv, ",%.3f,", gbytes );
+                    if ( roof > 0.0 )
+                        fprintf( csv, "%.3f", roof );
+                    fprintf( csv, ",%.4f,%s,%s\n", ofRoof, bound, coresName( bm.all_cores ) );
+                }
+            }
+        }
+    }
+
+    printf( "==========================================================================================================================\n" );
+}
+
+static const char* csvFilename = nullptr;
+
+static bool cmdRooflineCSV( uintptr_t, const char* filename )
+{
+    csvFilename = filename;
+    return true;
+}
+
+} // namespace roofline
+
+#endif // TETHER_BENCHMARK_ROOFLINE
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// name of an ISPC target in the same form as TargetISA in premake.lua, eg. "avx2-i32x16", from the values returned by
+// targetISA() and targetWidth()
+static std::string ispcTargetName( const int32_t isa, const int32_t width )
+{
+    static const char* isaNames[] = { "unknown", "neon", "sse2", "sse4", "avx1", "avx2", "avx512knl", "avx512skx" };
+
+    const char* isaName = ( isa >= 0 && isa < (int32_t)( sizeof( isaNames ) / sizeof( isaNames[0] ) ) ) ? isaNames[isa] : isaNames[0];
+
+    return utils::stringFormat( "%s-i32x%i", isaName, width );
+}
+
+// --isa=<name>, forcing every ISPC benchmark onto one target's variants; only useful in a multi-target build
+static bool cmdSelectISA( uintptr_t, const char* name )
+{
+    ispc_isa::Target target;
+    if ( !ispc_isa::targetFromName( name, target ) )
+    {
+        printf( "unknown ISA [%s], expected auto, sse4, avx2 or avx512skx\n", name );
+        return false;
+    }
+    if ( !ispc_isa::select( target ) )
+    {
+#if defined(TETHER_ISPC_MULTI_TARGET)
+        printf( "ISA [%s] is not supported by this CPU\n", name );
+#else
+        printf( "ISA [%s] is not available, this build was compiled for a single ISPC target (see Release-MultiISA in premake.lua)\n", name );
+#endif
+        return false;
+    }
+    return true;
+}
+
+// --no-output, skipping the PNG and WAV files the samples write on their first run
+static bool cmdNoOutput( uintptr_t, const char* arg )
+{
+    if ( *arg != '\0' )
+        return false;
+
+    container::outputFilesEnabled() = false;
+    return true;
+}
+
+int main( int argc, char** argv )
+{
+    printf( "Tether-ISPC\n" );
+    printf( "ishani.org 2020\n" );
+
+    printf( "--------------------------------------------\n" );
     printf( "Running benchmarks, this may take a while...\n\n" );
 
     picobench::runner benchmarking;
+    benchmarking.add_cmd_opt( "-isa=", "<auto|sse4|avx2|avx512skx>", "Runs ISPC code for one target rather than the best the CPU supports", cmdSelectISA );
+    benchmarking.add_cmd_opt( "-no-output", "", "Doesn't write the PNG / WAV output of each sample", cmdNoOutput );
+#ifdef TETHER_BENCHMARK_ROOFLINE
+    benchmarking.add_cmd_opt( "-roofline-csv=", "<filename>", "Also writes the roofline table as CSV", roofline::cmdRooflineCSV );
+#endif
     benchmarking.parse_cmd_line( argc, argv );
 
-    return benchmarking.run();
+    // --mem counts what the samples allocate through utils::allocateAlign16, which covers every container:: buffer, and
+    // the most of it live at once in each sample
+    benchmarking.set_allocation_counter( utils::readAllocationCounters, utils::resetAllocationPeak );
+
+    // recorded in --json / --out-fmt=json results, so runs from different machines and builds can be told apart
+    benchmarking.add_context( "cpu", utils::hostCPUName() );
+    benchmarking.add_context( "ispc_target", ispcTargetName( ispc_isa::targetISA(), ispc_isa::targetWidth() ) );
+    benchmarking.add_context( "ispc_half_width_target", ispcTargetName( ispc_isa::targetISA_narrow(), ispc_isa::targetWidth_narrow() ) );
+    benchmarking.add_context( "ispc_dispatch", ispc_isa::targetName( ispc_isa::selected() ) );
+#if defined(_WIN32)
+    benchmarking.add_context( "os", "windows" );
+#elif defined(__linux__)
+    benchmarking.add_context( "os", "linux" );
+#endif
+#if defined(DEBUG)
+    benchmarking.add_context( "build", "debug" );
+#else
+    benchmarking.add_context( "build", "release" );
+#endif
+
+    const int result = benchmarking.run();
+
+#ifdef TETHER_BENCHMARK_ROOFLINE
+    if ( benchmarking.preferred_output_format() == picobench::report_output_format::text )
+    {
+        FILE* csv = nullptr;
+        if ( roofline::csvFilename != nullptr )
+        {
+            csv = fopen( roofline::csvFilename, "w" );
+            if ( csv == nullptr )
+                printf( "\nunable to open [%s] for writing\n", roofline::csvFilename );
+        }
+
+        roofline::printTable( benchmarking.last_report(), csv );
+
+        if ( csv != nullptr )
+            fclose( csv );
+    }
+#endif
+
+#ifdef TETHER_BENCHMARK_APPROX
+    if ( benchmarking.preferred_output_format() == picobench::report_output_format::text )
+        approx::printErrorTable();
+#endif
+
+    TaskSystemStats taskStats;
+    GetTaskSystemStats( taskStats );
+    if ( taskStats.launches > 0 )
+    {
+        printf( "\ntask system : %llu launches, %llu tasks, %.1f ISPCAlloc bytes per launch, %llu arena blocks (%llu large page)\n",
+            (unsigned long long)taskStats.launches,
+            (unsigned long long)taskStats.tasks,
+            (double)taskStats.allocatedBytes / (double)taskStats.launches,
+            (unsigned long long)taskStats.arenaBlocks,
+            (unsigned long long)taskStats.largePageBlocks );
+    }
+
+    // join the task system worker threads; TETHER_TASK_THREADS / _CPUS / _PINNING control how they are created
+    ShutdownTaskSystem();
+
+    return result;
 }
\ No newline at end of file
@@ -107,6 +107,7 @@
 #include <cstdint>
 #include <chrono>
 #include <vector>
+#include <algorithm>
 
 #if defined(PICOBENCH_STD_FUNCTION_BENCHMARKS)
 #   include <functional>
@@ -150,6 +151,155 @@ using high_res_clock = std::chrono::high_resolution_clock;
 
 using result_t = intptr_t;
 
+// hardware performance counters, collected around each sample when enabled
+// with -perf (linux only, via perf_event_open)
+struct perf_values
+{
+    enum counter
+    {
+        cycles,
+        instructions,
+        l1d_misses, // L1 data cache read misses
+        llc_misses, // last level cache misses
+        branch_misses,
+        num_counters
+    };
+
+    uint64_t count[num_counters] = {};
+    uint64_t time_enabled[num_counters] = {}; // the kernel may multiplex counters if there aren't
+    uint64_t time_running[num_counters] = {}; // enough in hardware; counts are scaled up to compensate
+    bool valid = false;
+
+    bool available(counter c) const { return valid && time_running[c] > 0; }
+
+    double ipc() const
+    {
+        if (!available(cycles) || !available(instructions) || count[cycles] == 0) return 0;
+        return double(count[instructions]) / double(count[cycles]);
+    }
+
+    // counts accumulated from begin to end
+    static perf_values between(const perf_values& begin, const perf_values& end)
+    {
+        perf_values d;
+        d.valid = begin.valid && end.valid;
+        for (int i = 0; i < num_counters; ++i)
+        {
+            d.time_enabled[i] = end.time_enabled[i] - begin.time_enabled[i];
+            d.time_running[i] = end.time_running[i] - begin.time_running[i];
+
+            const uint64_t raw = end.count[i] - begin.count[i];
+            d.count[i] = (d.time_running[i] > 0 && d.time_running[i] < d.time_enabled[i]) ?
+                uint64_t(double(raw) * double(d.time_enabled[i]) / double(d.time_running[i])) : raw;
+        }
+        return d;
+    }
+};
+
+// reads the current counter values; returns false (and leaves values
+// invalid) if counters aren't being collected
+bool read_perf_counters(perf_values& values);
+
+// memory activity of the process, collected around each sample when enabled
+// with -mem. page faults come from the OS (getrusage; windows only counts
+// faults as a whole, reported as minor). picobench can't see the program's
+// allocator, so allocations and the bytes live at once are only counted if
+// the program registers an allocation_counter with the runner
+struct memory_values
+{
+    uint64_t minor_faults = 0; // satisfied without I/O, eg. first touch of a fresh page
+    uint64_t major_faults = 0; // needed I/O
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t peak_live_bytes = 0; // most bytes allocated and not yet freed at once during the sample, never a difference
+    bool valid = false;
+
+    uint64_t faults() const { return minor_faults + major_faults; }
+
+    // counts accumulated from begin to end
+    static memory_values between(const memory_values& begin, const memory_values& end)
+    {
+        memory_values d;
+        d.valid = begin.valid && end.valid;
+        d.minor_faults = end.minor_faults - begin.minor_faults;
+        d.major_faults = end.major_faults - begin.major_faults;
+        d.allocations = end.allocations - begin.allocations;
+        d.allocated_bytes = end.allocated_bytes - begin.allocated_bytes;
+        d.peak_live_bytes = end.peak_live_bytes;
+        return d;
+    }
+
+    // counts in whole that weren't in part, where part was measured inside whole
+    static memory_values excluding(const memory_values& whole, const memory_values& part)
+    {
+        if (!part.valid) return whole;
+        memory_values d = whole;
+        d.minor_faults -= std::min(part.minor_faults, whole.minor_faults);
+        d.major_faults -= std::min(part.major_faults, whole.major_faults);
+        d.allocations -= std::min(part.allocations, whole.allocations);
+        d.allocated_bytes -= std::min(part.allocated_bytes, whole.allocated_bytes);
+        return d;
+    }
+
+    // counts averaged over the valid values, with the largest live peak
+    static memory_values mean(const std::vector<memory_values>& values)
+    {
+        memory_values m;
+        uint64_t n = 0;
+        for (auto& v : values)
+        {
+            if (!v.valid) continue;
+            m.minor_faults += v.minor_faults;
+            m.major_faults += v.major_faults;
+            m.allocations += v.allocations;
+            m.allocated_bytes += v.allocated_bytes;
+            m.peak_live_bytes = std::max(m.peak_live_bytes, v.peak_live_bytes);
+            ++n;
+        }
+        if (n == 0) return m;
+
+        m.minor_faults = (m.minor_faults + n / 2) / n;
+        m.major_faults = (m.major_faults + n / 2) / n;
+        m.allocations = (m.allocations + n / 2) / n;
+        m.allocated_bytes = (m.allocated_bytes + n / 2) / n;
+        m.valid = true;
+        return m;
+    }
+};
+
+// reports how many allocations the program has made so far, their total size
+// in bytes and the most bytes it has had live at once since the last
+// allocation_peak_reset; see runner::set_allocation_counter
+using allocation_counter = void(*)(uint64_t& allocations, uint64_t& bytes, uint64_t& peak_live_bytes);
+
+// starts a new live high-water mark from the bytes live now; called at the
+// start of every sample, so each row reports its own peak
+using allocation_peak_reset = void(*)();
+
+// reads the current memory values; returns false (and leaves values invalid)
+// if memory activity isn't being collected
+bool read_memory_values(memory_values& values);
+
+// how far the output of a benchmark is from a reference implementation, for
+// benchmarks that check themselves against one (see state::set_accuracy).
+// a row fails when it is outside either limit; limits left at zero aren't applied
+struct accuracy_t
+{
+    bool valid = false;
+    double max_abs_error = 0; // largest difference of any one value
+    double psnr = 0; // dB against the peak of the reference; infinite if identical
+    double max_abs_limit = 0; // fail if max_abs_error is above this
+    double min_psnr = 0; // fail if psnr is below this
+
+    bool failed() const
+    {
+        // written so that NaNs fail
+        return valid &&
+            ((max_abs_limit > 0 && !(max_abs_error <= max_abs_limit)) ||
+             (min_psnr > 0 && !(psnr >= min_psnr)));
+    }
+};
+
 class state
 {
 public:
@@ -162,7 +312,7 @@ public:
     }
 
     PICOBENCH_INLINE int iterations() const { return _iterations; }
-    PICOBENCH_INLINE int sampleIndex() const { return _sample_index; }
+    PICOBENCH_INLINE int sampleIndex() const { return _sample_index; } // -1 for warmup runs
 
     PICOBENCH_INLINE int64_t duration_ns() const { return _duration_ns; }
     PICOBENCH_INLINE void add_custom_duration(int64_t duration_ns) { _duration_ns += duration_ns; }
@@ -175,9 +325,25 @@ public:
     PICOBENCH_INLINE void set_result(uintptr_t data) { _result = data; }
     PICOBENCH_INLINE result_t result() const { return _result; }
 
+    // optionally report how far the output is from a reference; usually only
+    // worth computing on one sample, eg. when sampleIndex() is 0
+    PICOBENCH_INLINE void set_accuracy(const accuracy_t& a) { _accuracy = a; }
+    PICOBENCH_INLINE const accuracy_t& accuracy() const { return _accuracy; }
+
+    // hardware counters for the timed part of the sample; invalid unless collected
+    PICOBENCH_INLINE const perf_values& perf() const { return _perf; }
+
+    // memory activity inside the timed part of the sample, and in the rest of
+    // the run of the benchmark function; invalid unless collected
+    PICOBENCH_INLINE const memory_values& memory() const { return _memory; }
+    PICOBENCH_INLINE memory_values memory_outside() const { return memory_values::excluding(_memory_sample, _memory); }
+
     PICOBENCH_INLINE
     void start_timer()
     {
+        // counters are read outside the clock so the reads aren't timed
+        read_memory_values(_memory_start);
+        read_perf_counters(_perf_start);
         _start = high_res_clock::now();
     }
 
@@ -186,6 +352,18 @@ public:
     {
         auto duration = high_res_clock::now() - _start;
         _duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+
+        perf_values perf_end;
+        if (read_perf_counters(perf_end))
+        {
+            _perf = perf_values::between(_perf_start, perf_end);
+        }
+
+        memory_values memory_end;
+        if (read_memory_values(memory_end))
+        {
+            _memory = memory_values::between(_memory_start, memory_end);
+        }
     }
 
     struct iterator
@@ -248,12 +426,20 @@ public:
     }
 
 private:
+    friend class runner; // records _memory_sample around the benchmark function
+
     high_res_clock::time_point _start;
     int64_t _duration_ns = 0;
+    perf_values _perf_start;
+    perf_values _perf;
+    memory_values _memory_start;
+    memory_values _memory;
+    memory_values _memory_sample;
     uintptr_t _user_data;
     int _iterations;
     int _sample_index;
     result_t _result = 0;
+    accuracy_t _accuracy;
 };
 
 // this can be used for manual measurement
@@ -282,6 +468,20 @@ using benchmark_proc = std::function<void(state&)>;
 using benchmark_proc = void(*)(state&);
 #endif
 
+// the work done by one run of a benchmark at a given dimension, so the report
+// can show throughput in real units (Mpix/s, GFLOP/s, GB/s) that compare across
+// problem sizes and against what the machine can sustain. anything left at zero
+// isn't reported
+struct work_units
+{
+    double items = 0;           // things processed - pixels, audio samples, FFT points...
+    const char* unit = nullptr; // short name for items, eg. "pix"
+    double flops = 0;           // estimated floating point operations
+    double bytes = 0;           // estimated bytes read and written
+};
+
+using work_proc = work_units(*)(int dimension);
+
 class benchmark
 {
 public:
@@ -289,9 +489,14 @@ public:
 
     benchmark& iterations(std::vector<int> data) { _state_iterations = std::move(data); return *this; }
     benchmark& samples(int n) { _samples = n; return *this; }
+    benchmark& warmup(int n) { _warmup = n; return *this; }
     benchmark& label(const char* label) { _name = label; return *this; }
     benchmark& baseline(bool b = true) { _baseline = b; return *this; }
     benchmark& user_data(uintptr_t data) { _user_data = data; return *this; }
+    benchmark& work(work_proc proc) { _work = proc; return *this; }
+    // the benchmark spreads over several threads (eg. a task system); it runs
+    // without the runner's binding to the first cpu
+    benchmark& all_cores(bool b = true) { _all_cores = b; return *this; }
 
 protected:
     friend class runner;
@@ -305,6 +510,9 @@ protected:
     uintptr_t _user_data = 0;
     std::vector<int> _state_iterations;
     int _samples = 0;
+    int _warmup = -1; // -1 uses the runner's default
+    work_proc _work = nullptr;
+    bool _all_cores = false;
 };
 
 // used for globally  functions
@@ -344,11 +552,26 @@ public:
 #include <memory>
 #include <cstring>
 #include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <regex>
+
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
 
 #if defined(_WIN32)
 #   define WIN32_LEAN_AND_MEAN
 #   include <Windows.h>
+#   include <psapi.h>
+#   pragma comment(lib, "psapi.lib")
 #else
+#   include <sys/resource.h>
 #   if !defined(PICOBENCH_DONT_BIND_TO_ONE_CORE)
 #       if defined(__APPLE__)
 #           include <mach/mach.h>
@@ -371,6 +594,74 @@ enum error_t
     error_unknown_cmd_line_argument, // command argument looks like a picobench one, but isn't
     error_sample_compare, // benchmark produced different results across samples
     error_benchmark_compare, // two benchmarks of the same suite and dimension produced different results
+    error_baseline_file, // the baseline file given to --compare couldn't be read
+    error_regression, // a benchmark was slower than its baseline by more than the tolerance
+    error_accuracy, // a benchmark's output was further from its reference than its limits allow
+};
+
+// distribution of sample times for one benchmark at one dimension
+struct sample_stats
+{
+    int64_t median_ns = 0;
+    int64_t p90_ns = 0;
+    int64_t p99_ns = 0;
+    double mean_ns = 0;
+    double stddev_ns = 0;
+    double ci = 0; // half-width of the 95% confidence interval of the mean, relative to the mean
+
+    static sample_stats from(std::vector<int64_t> times)
+    {
+        sample_stats st;
+        if (times.empty()) return st;
+
+        std::sort(times.begin(), times.end());
+        st.median_ns = percentile(times, 0.5);
+        st.p90_ns = percentile(times, 0.9);
+        st.p99_ns = percentile(times, 0.99);
+
+        const size_t n = times.size();
+        for (auto t : times) st.mean_ns += double(t);
+        st.mean_ns /= double(n);
+
+        if (n > 1)
+        {
+            double sum_sq = 0;
+            for (auto t : times) sum_sq += (double(t) - st.mean_ns) * (double(t) - st.mean_ns);
+            st.stddev_ns = std::sqrt(sum_sq / double(n - 1));
+
+            if (st.mean_ns > 0)
+                st.ci = student_t95(int(n - 1)) * st.stddev_ns / std::sqrt(double(n)) / st.mean_ns;
+        }
+        else
+        {
+            // a single sample says nothing about the spread
+            st.ci = std::numeric_limits<double>::infinity();
+        }
+        return st;
+    }
+
+private:
+    // linear interpolation between the closest ranks of sorted times
+    static int64_t percentile(const std::vector<int64_t>& sorted, double p)
+    {
+        const double rank = p * double(sorted.size() - 1);
+        const size_t lo = size_t(rank);
+        const size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + int64_t((rank - double(lo)) * double(sorted[hi] - sorted[lo]));
+    }
+
+    // two-sided 95% critical values of Student's t distribution
+    static double student_t95(int dof)
+    {
+        static const double table[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+        };
+        if (dof < 1) return std::numeric_limits<double>::infinity();
+        if (dof <= 30) return table[dof - 1];
+        return dof <= 60 ? 2.000 : (dof <= 120 ? 1.980 : 1.960);
+    }
 };
 
 class report
@@ -378,15 +669,22 @@ class report
 public:
     struct benchmark_problem_space
     {
-        int dimension; // number of iterations for the problem space
-        int samples; // number of samples taken
-        int64_t total_time_ns; // fastest sample!!!
-        result_t result; // result of fastest sample
+        int dimension = 0; // number of iterations for the problem space
+        int samples = 0; // number of samples taken
+        int64_t total_time_ns = 0; // fastest sample!!!
+        result_t result = 0; // result of fastest sample
+        perf_values perf; // hardware counters of fastest sample
+        sample_stats stats; // spread over all samples
+        work_units work; // work done by one run at this dimension
+        accuracy_t accuracy; // error against a reference, if the benchmark checked itself
+        memory_values memory; // memory activity inside the timer, mean of all samples
+        memory_values memory_outside; // and in the rest of the benchmark function
     };
     struct benchmark
     {
         const char* name;
         bool is_baseline;
+        bool all_cores = false; // ran without the binding to the first cpu, see benchmark::all_cores
         std::vector<benchmark_problem_space> data;
     };
 
@@ -420,6 +718,10 @@ public:
 
     std::vector<suite> suites;
     error_t error = no_error;
+    bool show_stats = false; // median/p90/p99/stddev/CI columns
+
+    // describes where the results came from (host cpu, compiler, ...); written to json
+    std::vector<std::pair<std::string, std::string>> context;
 
     const suite* find_suite(const char* name) const
     {
@@ -432,9 +734,51 @@ public:
         return nullptr;
     }
 
+    // true if any benchmark in the suite declared its work
+    static bool has_work(const suite& s)
+    {
+        for (auto& bm : s.benchmarks)
+            for (auto& d : bm.data)
+                if (d.work.items > 0 || d.work.flops > 0 || d.work.bytes > 0) return true;
+        return false;
+    }
+
+    // true if any benchmark in the suite checked its output against a reference
+    static bool has_accuracy(const suite& s)
+    {
+        for (auto& bm : s.benchmarks)
+            for (auto& d : bm.data)
+                if (d.accuracy.valid) return true;
+        return false;
+    }
+
+    // true if any sample has hardware counters
+    bool has_perf() const
+    {
+        for (auto& suite : suites)
+            for (auto& bm : suite.benchmarks)
+                for (auto& d : bm.data)
+                    if (d.perf.valid) return true;
+        return false;
+    }
+
+    // true if any sample has memory activity
+    bool has_memory() const
+    {
+        for (auto& suite : suites)
+            for (auto& bm : suite.benchmarks)
+                for (auto& d : bm.data)
+                    if (d.memory.valid || d.memory_outside.valid) return true;
+        return false;
+    }
+
     void to_text(std::ostream& out) const
     {
         using namespace std;
+        const bool perf = has_perf();
+        const bool memory = has_memory();
+        const int width = 79 + (show_stats ? 55 : 0) + (perf ? 63 : 0) + (memory ? 60 : 0);
+
         for (auto& suite : suites)
         {
             if (suite.name)
@@ -442,10 +786,35 @@ public:
                 out << suite.name << ":\n";
             }
 
-            line(out);
+            const bool work = has_work(suite);
+            const bool accuracy = has_accuracy(suite);
+            const int suite_width = width + (work ? 37 : 0) + (accuracy ? 25 : 0);
+
+            line(out, suite_width);
             out <<
-                "   Name (baseline is *)   |   Dim   |  Total ms |  ns/op  |Baseline| Ops/second\n";
-            line(out);
+                "   Name (baseline is *)   |   Dim   |  Total ms |  ns/op  |Baseline| Ops/second";
+            if (work)
+            {
+                out << " |    Throughput  | GFLOP/s |   GB/s";
+            }
+            if (accuracy)
+            {
+                out << " |   PSNR dB  | Max error";
+            }
+            if (show_stats)
+            {
+                out << " | Smp | Median ms |  p90 ms  |  p99 ms  | Stddev | CI 95%";
+            }
+            if (perf)
+            {
+                out << " |   Cycles |   Instrs |   IPC | L1D miss | LLC miss | Br. miss";
+            }
+            if (memory)
+            {
+                out << " | Faults in | Fault out | Allocs in |Allocs out | Peak live";
+            }
+            out << "\n";
+            line(out, suite_width);
 
             auto problem_space_view = get_problem_space_view(suite);
             for (auto& ps : problem_space_view)
@@ -509,10 +878,57 @@ public:
                     }
 
                     auto ops_per_sec = ps.first * (1000000000.0 / double(bm.total_time_ns));
-                    out << setw(11) << fixed << setprecision(1) << ops_per_sec << "\n";
+                    out << setw(11) << fixed << setprecision(1) << ops_per_sec;
+
+                    if (work)
+                    {
+                        const double per_sec = 1000000000.0 / double(bm.total_time_ns);
+                        throughput(out, bm.work.items * per_sec, bm.work.unit ? bm.work.unit : "op");
+                        rate(out, bm.work.flops * per_sec * 1e-9, 8);
+                        rate(out, bm.work.bytes * per_sec * 1e-9, 7);
+                    }
+
+                    if (accuracy)
+                    {
+                        accuracy_columns(out, bm.accuracy);
+                    }
+
+                    if (show_stats)
+                    {
+                        auto& st = bm.stats;
+                        out << " |" << setw(4) << bm.samples
+                            << " |" << setw(10) << fixed << setprecision(3) << double(st.median_ns) / 1000000.0
+                            << " |" << setw(9) << fixed << setprecision(3) << double(st.p90_ns) / 1000000.0
+                            << " |" << setw(9) << fixed << setprecision(3) << double(st.p99_ns) / 1000000.0;
+                        percent(out, st.mean_ns > 0 ? st.stddev_ns / st.mean_ns : 0, 7);
+                        percent(out, st.ci, 7);
+                    }
+
+                    if (perf)
+                    {
+                        perf_count(out, bm.perf, perf_values::cycles);
+                        perf_count(out, bm.perf, perf_values::instructions);
+                        if (bm.perf.ipc() > 0)
+                            out << " |" << setw(6) << fixed << setprecision(2) << bm.perf.ipc();
+                        else
+                            out << " |     -";
+                        perf_count(out, bm.perf, perf_values::l1d_misses);
+                        perf_count(out, bm.perf, perf_values::llc_misses);
+                        perf_count(out, bm.perf, perf_values::branch_misses);
+                    }
+
+                    if (memory)
+                    {
+                        memory_count(out, bm.memory.faults(), bm.memory.valid);
+                        memory_count(out, bm.memory_outside.faults(), bm.memory_outside.valid);
+                        memory_count(out, bm.memory.allocations, bm.memory.valid);
+                        memory_count(out, bm.memory_outside.allocations, bm.memory_outside.valid);
+                        memory_bytes(out, bm.memory_outside.peak_live_bytes, bm.memory_outside.valid);
+                    }
+                    out << "\n";
                 }
             }
-            line(out);
+            line(out, suite_width);
         }
     }
 
@@ -596,9 +1012,40 @@ public:
     {
         using namespace std;
 
+        const bool perf = has_perf();
+        const bool memory = has_memory();
+        bool work = false, accuracy = false;
+        for (auto& suite : suites)
+        {
+            work = work || has_work(suite);
+            accuracy = accuracy || has_accuracy(suite);
+        }
+
         if (header)
         {
-            out << "Suite,Benchmark,b,D,S,\"Total ns\",Result,\"ns/op\",Baseline\n";
+            out << "Suite,Benchmark,b,D,S,\"Total ns\",Result,\"ns/op\",Baseline";
+            if (work)
+            {
+                out << ",Unit,\"Items/second\",\"GFLOP/s\",\"GB/s\"";
+            }
+            if (accuracy)
+            {
+                out << ",\"PSNR dB\",\"Max error\",Accuracy";
+            }
+            if (show_stats)
+            {
+                out << ",\"Median ns\",\"p90 ns\",\"p99 ns\",\"Stddev ns\",\"CI 95%\"";
+            }
+            if (perf)
+            {
+                out << ",Cycles,Instructions,IPC,\"L1D misses\",\"LLC misses\",\"Branch misses\"";
+            }
+            if (memory)
+            {
+                out << ",\"Minor faults in\",\"Major faults in\",\"Allocs in\",\"Alloc bytes in\""
+                       ",\"Minor faults out\",\"Major faults out\",\"Allocs out\",\"Alloc bytes out\",\"Peak live bytes\"";
+            }
+            out << '\n';
         }
 
         for (auto& suite : suites)
@@ -645,18 +1092,235 @@ public:
                         }
                     }
 
+                    if (work)
+                    {
+                        // rates that weren't declared are left empty
+                        const double per_sec = 1000000000.0 / double(d.total_time_ns);
+                        out << ',';
+                        if (d.work.items > 0)
+                            out << (d.work.unit ? d.work.unit : "op");
+                        out << ',';
+                        if (d.work.items > 0)
+                            out << fixed << setprecision(1) << d.work.items * per_sec;
+                        out << ',';
+                        if (d.work.flops > 0)
+                            out << fixed << setprecision(3) << d.work.flops * per_sec * 1e-9;
+                        out << ',';
+                        if (d.work.bytes > 0)
+                            out << fixed << setprecision(3) << d.work.bytes * per_sec * 1e-9;
+                    }
+
+                    if (accuracy)
+                    {
+                        // rows that didn't check themselves are left empty
+                        out << ',';
+                        if (d.accuracy.valid)
+                        {
+                            if (std::isfinite(d.accuracy.psnr))
+                                out << fixed << setprecision(2) << d.accuracy.psnr;
+                            else
+                                out << "inf";
+                        }
+                        out << ',';
+                        if (d.accuracy.valid)
+                            out << scientific << setprecision(3) << d.accuracy.max_abs_error << defaultfloat;
+                        out << ',';
+                        if (d.accuracy.valid)
+                            out << (d.accuracy.failed() ? "fail" : "pass");
+                    }
+
+                    if (show_stats)
+                    {
+                        out << ',' << d.stats.median_ns
+                            << ',' << d.stats.p90_ns
+                            << ',' << d.stats.p99_ns
+                            << ',' << fixed << setprecision(1) << d.stats.stddev_ns << ',';
+                        if (std::isfinite(d.stats.ci))
+                            out << fixed << setprecision(4) << d.stats.ci;
+                    }
+
+                    if (perf)
+                    {
+                        // counters that weren't collected are left empty
+                        for (int c = 0; c < perf_values::num_counters; ++c)
+                        {
+                            out << ',';
+                            if (d.perf.available(perf_values::counter(c)))
+                                out << d.perf.count[c];
+                            if (c == perf_values::instructions)
+                            {
+                                out << ',';
+                                if (d.perf.ipc() > 0)
+                                    out << fixed << setprecision(3) << d.perf.ipc();
+                            }
+                        }
+                    }
+
+                    if (memory)
+                    {
+                        // inside then outside the timer, empty if not collected
+                        for (auto m : { &d.memory, &d.memory_outside })
+                        {
+                            if (m->valid)
+                                out << ',' << m->minor_faults << ',' << m->major_faults << ',' << m->allocations << ',' << m->allocated_bytes;
+                            else
+                                out << ",,,,";
+                        }
+                        out << ',';
+                        if (d.memory_outside.valid)
+                            out << d.memory_outside.peak_live_bytes;
+                    }
+
                     out << '\n';
                 }
             }
         }
     }
 
+    // one object per run; "suites" holds a row per benchmark per dimension.
+    // statistics and hardware counters are only written if they were collected
+    void to_json(std::ostream& out) const
+    {
+        using namespace std;
+        const bool perf = has_perf();
+
+        out << "{\n";
+        out << "  \"picobench\": \"" PICOBENCH_VERSION_STR "\",\n";
+        out << "  \"context\": {";
+        for (size_t i = 0; i < context.size(); ++i)
+        {
+            out << (i ? ",\n    " : "\n    ");
+            json_string(out, context[i].first.c_str());
+            out << ": ";
+            json_string(out, context[i].second.c_str());
+        }
+        out << (context.empty() ? "},\n" : "\n  },\n");
+
+        out << "  \"suites\": [";
+        for (size_t si = 0; si < suites.size(); ++si)
+        {
+            auto& suite = suites[si];
+            const benchmark* baseline = suite.find_baseline();
+
+            out << (si ? ",\n" : "\n") << "    {\n      \"name\": ";
+            json_string(out, suite.name);
+            out << ",\n      \"rows\": [";
+
+            bool first_row = true;
+            for (auto& bm : suite.benchmarks)
+            {
+                for (auto& d : bm.data)
+                {
+                    out << (first_row ? "\n" : ",\n") << "        { \"benchmark\": ";
+                    first_row = false;
+
+                    json_string(out, bm.name);
+                    out << ", \"baseline\": " << (&bm == baseline ? "true" : "false")
+                        << ", \"dimension\": " << d.dimension
+                        << ", \"samples\": " << d.samples
+                        << ", \"total_ns\": " << d.total_time_ns
+                        << ", \"ns_per_op\": " << fixed << setprecision(3) << double(d.total_time_ns) / double(d.dimension)
+                        << ", \"ops_per_second\": " << setprecision(3) << d.dimension * (1000000000.0 / double(d.total_time_ns))
+                        << ", \"result\": " << d.result;
+
+                    if (baseline)
+                    {
+                        for (auto& bd : baseline->data)
+                        {
+                            if (bd.dimension == d.dimension)
+                            {
+                                out << ", \"baseline_ratio\": " << setprecision(4) << double(d.total_time_ns) / double(bd.total_time_ns);
+                            }
+                        }
+                    }
+
+                    {
+                        const double per_sec = 1000000000.0 / double(d.total_time_ns);
+                        if (d.work.items > 0)
+                        {
+                            out << ", \"unit\": ";
+                            json_string(out, d.work.unit ? d.work.unit : "op");
+                            out << ", \"items\": " << setprecision(0) << d.work.items
+                                << ", \"items_per_second\": " << setprecision(1) << d.work.items * per_sec;
+                        }
+                        if (d.work.flops > 0)
+                            out << ", \"flops\": " << setprecision(0) << d.work.flops
+                                << ", \"gflop_per_second\": " << setprecision(4) << d.work.flops * per_sec * 1e-9;
+                        if (d.work.bytes > 0)
+                            out << ", \"bytes\": " << setprecision(0) << d.work.bytes
+                                << ", \"gb_per_second\": " << setprecision(4) << d.work.bytes * per_sec * 1e-9;
+                    }
+
+                    if (d.accuracy.valid)
+                    {
+                        // identical output has no finite PSNR, which json can't express; it is left out
+                        out << ", \"max_abs_error\": " << scientific << setprecision(6) << d.accuracy.max_abs_error << fixed;
+                        if (std::isfinite(d.accuracy.psnr))
+                            out << ", \"psnr_db\": " << setprecision(3) << d.accuracy.psnr;
+                        out << ", \"accuracy_passed\": " << (d.accuracy.failed() ? "false" : "true");
+                    }
+
+                    if (show_stats)
+                    {
+                        out << ", \"median_ns\": " << d.stats.median_ns
+                            << ", \"p90_ns\": " << d.stats.p90_ns
+                            << ", \"p99_ns\": " << d.stats.p99_ns
+                            << ", \"stddev_ns\": " << setprecision(1) << d.stats.stddev_ns;
+                        if (std::isfinite(d.stats.ci))
+                            out << ", \"ci95\": " << setprecision(5) << d.stats.ci;
+                    }
+
+                    if (perf && d.perf.valid)
+                    {
+                        static const char* names[perf_values::num_counters] = {
+                            "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+                        };
+                        for (int c = 0; c < perf_values::num_counters; ++c)
+                        {
+                            if (d.perf.available(perf_values::counter(c)))
+                                out << ", \"" << names[c] << "\": " << d.perf.count[c];
+                        }
+                        if (d.perf.ipc() > 0)
+                            out << ", \"ipc\": " << setprecision(3) << d.perf.ipc();
+                    }
+
+                    if (d.memory.valid)
+                    {
+                        out << ", \"minor_faults_in\": " << d.memory.minor_faults
+                            << ", \"major_faults_in\": " << d.memory.major_faults
+                            << ", \"allocations_in\": " << d.memory.allocations
+                            << ", \"allocated_bytes_in\": " << d.memory.allocated_bytes;
+                    }
+                    if (d.memory_outside.valid)
+                    {
+                        out << ", \"minor_faults_out\": " << d.memory_outside.minor_faults
+                            << ", \"major_faults_out\": " << d.memory_outside.major_faults
+                            << ", \"allocations_out\": " << d.memory_outside.allocations
+                            << ", \"allocated_bytes_out\": " << d.memory_outside.allocated_bytes
+                            << ", \"peak_live_bytes\": " << d.memory_outside.peak_live_bytes;
+                    }
+
+                    out << " }";
+                }
+            }
+            out << (first_row ? "]\n    }" : "\n      ]\n    }");
+        }
+        out << (suites.empty() ? "]\n" : "\n  ]\n") << "}\n";
+    }
+
     struct problem_space_benchmark
     {
         const char* name;
         bool is_baseline;
         int64_t total_time_ns; // fastest sample!!!
         result_t result; // result of fastest sample
+        perf_values perf; // hardware counters of fastest sample
+        int samples;
+        sample_stats stats;
+        work_units work;
+        accuracy_t accuracy;
+        memory_values memory;
+        memory_values memory_outside;
     };
 
     static std::map<int, std::vector<problem_space_benchmark>> get_problem_space_view(const suite& s)
@@ -664,21 +1328,525 @@ public:
         std::map<int, std::vector<problem_space_benchmark>> res;
         for (auto& bm : s.benchmarks)
         {
-            for (auto& d : bm.data)
+            for (auto& d : bm.data)
+            {
+                auto& pvbs = res[d.dimension];
+                pvbs.push_back({ bm.name, bm.is_baseline, d.total_time_ns, d.result, d.perf, d.samples, d.stats, d.work, d.accuracy, d.memory, d.memory_outside });
+            }
+        }
+        return res;
+    }
+
+private:
+
+    static void line(std::ostream& out, int width = 79)
+    {
+        for (int i = 0; i < width; ++i) out.put('=');
+        out.put('\n');
+    }
+
+    static void json_string(std::ostream& out, const char* str)
+    {
+        if (!str)
+        {
+            out << "null";
+            return;
+        }
+
+        out << '"';
+        for (auto p = str; *p; ++p)
+        {
+            const char c = *p;
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else if (c == '\n') out << "\\n";
+            else if (c == '\t') out << "\\t";
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", unsigned(c));
+                out << esc;
+            }
+            else out << c;
+        }
+        out << '"';
+    }
+
+    // ratio as a percentage column of the given width, '-' if unknown
+    static void percent(std::ostream& out, double ratio, int w)
+    {
+        using namespace std;
+        out << " |";
+        if (!std::isfinite(ratio))
+            out << setw(w) << "-";
+        else
+            out << setw(w - 1) << fixed << setprecision(ratio < 0.1 ? 2 : 1) << ratio * 100.0 << '%';
+    }
+
+    // items per second as a 15 character column, scaled to K/M/G and followed by the unit name
+    static void throughput(std::ostream& out, double per_sec, const char* unit)
+    {
+        using namespace std;
+        out << " |";
+        if (!(per_sec > 0) || !std::isfinite(per_sec))
+        {
+            out << "              - ";
+            return;
+        }
+
+        const char* prefix = "";
+        if (per_sec >= 1e9) { per_sec /= 1e9; prefix = "G"; }
+        else if (per_sec >= 1e6) { per_sec /= 1e6; prefix = "M"; }
+        else if (per_sec >= 1e3) { per_sec /= 1e3; prefix = "K"; }
+
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "%s%.5s/s", prefix, unit);
+        out << setw(8) << fixed << setprecision(2) << per_sec << ' ' << left << setw(7) << suffix << right;
+    }
+
+    // rate in billions per second as a column of the given width, '-' if not declared
+    static void rate(std::ostream& out, double giga_per_sec, int w)
+    {
+        using namespace std;
+        out << " |";
+        if (!(giga_per_sec > 0) || !std::isfinite(giga_per_sec))
+            out << setw(w) << "-";
+        else
+            out << setw(w) << fixed << setprecision(giga_per_sec < 10 ? 3 : 1) << giga_per_sec;
+    }
+
+    // PSNR and max error as 11 and 10 character columns; a '!' after the PSNR marks a row outside its limits
+    static void accuracy_columns(std::ostream& out, const accuracy_t& a)
+    {
+        using namespace std;
+        out << " |";
+        if (!a.valid)
+        {
+            out << "         -  |         -";
+            return;
+        }
+
+        if (std::isfinite(a.psnr))
+            out << setw(10) << fixed << setprecision(2) << a.psnr;
+        else
+            out << setw(10) << "inf";
+        out << (a.failed() ? '!' : ' ') << " |"
+            << setw(10) << scientific << setprecision(2) << a.max_abs_error << fixed;
+    }
+
+    // counter value as a 9 character column, scaled to K/M/G
+    static void perf_count(std::ostream& out, const perf_values& perf, perf_values::counter c)
+    {
+        using namespace std;
+        out << " |";
+        if (!perf.available(c))
+        {
+            out << "        -";
+            return;
+        }
+
+        double v = double(perf.count[c]);
+        const char* suffix = " ";
+        if (v >= 1e9) { v /= 1e9; suffix = "G"; }
+        else if (v >= 1e6) { v /= 1e6; suffix = "M"; }
+        else if (v >= 1e3) { v /= 1e3; suffix = "K"; }
+        out << setw(8) << fixed << setprecision(v < 1000 && *suffix != ' ' ? 2 : 0) << v << suffix;
+    }
+
+    // count as a 10 character column, scaled to K/M/G
+    static void memory_count(std::ostream& out, uint64_t count, bool valid)
+    {
+        using namespace std;
+        out << " |";
+        if (!valid)
+        {
+            out << "         -";
+            return;
+        }
+
+        double v = double(count);
+        const char* suffix = " ";
+        if (v >= 1e9) { v /= 1e9; suffix = "G"; }
+        else if (v >= 1e6) { v /= 1e6; suffix = "M"; }
+        else if (v >= 1e3) { v /= 1e3; suffix = "K"; }
+        out << setw(9) << fixed << setprecision(v < 1000 && *suffix != ' ' ? 2 : 0) << v << suffix;
+    }
+
+    // size in bytes as a 10 character column, scaled to KB/MB/GB
+    static void memory_bytes(std::ostream& out, uint64_t bytes, bool valid)
+    {
+        using namespace std;
+        out << " |";
+        if (!valid || bytes == 0)
+        {
+            out << "         -";
+            return;
+        }
+
+        double v = double(bytes) / 1024.0;
+        const char* suffix = "KB";
+        if (v >= 1024.0 * 1024.0) { v /= 1024.0 * 1024.0; suffix = "GB"; }
+        else if (v >= 1024.0) { v /= 1024.0; suffix = "MB"; }
+        out << setw(7) << fixed << setprecision(1) << v << ' ' << suffix;
+    }
+};
+
+// collects hardware counters for the benchmarking thread and every thread it
+// starts after the counters are opened (so task system workers that are
+// created lazily are included). counters the cpu or kernel won't provide - for
+// example when perf_event_paranoid forbids it, or in a VM - are left out
+class perf_counters
+{
+public:
+    static perf_counters& instance()
+    {
+        static perf_counters pc;
+        return pc;
+    }
+
+    // returns the number of counters that could be opened
+    int open()
+    {
+        close();
+#if defined(__linux__)
+        struct event { uint32_t type; uint64_t config; };
+        const event events[perf_values::num_counters] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        };
+
+        for (int i = 0; i < perf_values::num_counters; ++i)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            _fd[i] = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+            if (_fd[i] >= 0)
+                ++_open;
+        }
+#endif
+        return _open;
+    }
+
+    void close()
+    {
+#if defined(__linux__)
+        for (auto& fd : _fd)
+        {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+#endif
+        _open = 0;
+    }
+
+    bool read(perf_values& values) const
+    {
+        if (_open == 0) return false;
+#if defined(__linux__)
+        for (int i = 0; i < perf_values::num_counters; ++i)
+        {
+            uint64_t data[3] = { 0, 0, 0 }; // value, time enabled, time running
+            if (_fd[i] >= 0 && ::read(_fd[i], data, sizeof(data)) == sizeof(data))
+            {
+                values.count[i] = data[0];
+                values.time_enabled[i] = data[1];
+                values.time_running[i] = data[2];
+            }
+        }
+        values.valid = true;
+        return true;
+#else
+        (void)values;
+        return false;
+#endif
+    }
+
+private:
+    perf_counters()
+    {
+        for (auto& fd : _fd) fd = -1;
+    }
+    ~perf_counters() { close(); }
+
+    int _fd[perf_values::num_counters];
+    int _open = 0;
+};
+
+bool read_perf_counters(perf_values& values)
+{
+    return perf_counters::instance().read(values);
+}
+
+// page faults of the whole process, plus whatever the program's
+// allocation_counter reports
+class memory_counters
+{
+public:
+    static memory_counters& instance()
+    {
+        static memory_counters mc;
+        return mc;
+    }
+
+    void open(allocation_counter counter, allocation_peak_reset reset)
+    {
+        _allocation_counter = counter;
+        _allocation_peak_reset = reset;
+        _open = true;
+    }
+
+    void close() { _open = false; }
+
+    void reset_peak() const
+    {
+        if (_open && _allocation_peak_reset)
+            _allocation_peak_reset();
+    }
+
+    bool read(memory_values& values) const
+    {
+        if (!_open) return false;
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        {
+            values.minor_faults = pmc.PageFaultCount;
+        }
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+            values.minor_faults = uint64_t(usage.ru_minflt);
+            values.major_faults = uint64_t(usage.ru_majflt);
+        }
+#endif
+        if (_allocation_counter)
+            _allocation_counter(values.allocations, values.allocated_bytes, values.peak_live_bytes);
+        values.valid = true;
+        return true;
+    }
+
+private:
+    memory_counters() = default;
+
+    allocation_counter _allocation_counter = nullptr;
+    allocation_peak_reset _allocation_peak_reset = nullptr;
+    bool _open = false;
+};
+
+bool read_memory_values(memory_values& values)
+{
+    return memory_counters::instance().read(values);
+}
+
+// the runner's thread is pinned to the first cpu so the high resolution clock
+// doesn't miss cycles; benchmarks marked all_cores() get the affinity the
+// thread started with back while they run, so threads they spawn (which
+// inherit it on linux) can spread over the machine
+class core_binding
+{
+public:
+    void bind()
+    {
+#if !defined(PICOBENCH_DONT_BIND_TO_ONE_CORE)
+#if defined(_WIN32)
+        _original = SetThreadAffinityMask(GetCurrentThread(), 1);
+#elif defined(__APPLE__)
+        thread_affinity_policy_data_t policy = {0};
+        thread_policy_set(
+            pthread_mach_thread_np(pthread_self()),
+            THREAD_AFFINITY_POLICY,
+            (thread_policy_t)&policy, 1);
+#else
+        sched_getaffinity(0, sizeof(cpu_set_t), &_original);
+
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(0, &cpuset);
+
+        sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
+#endif
+        _bound = true;
+#endif
+    }
+
+    // switch between the first cpu and the original affinity; a no-op when
+    // already in the requested state or if bind() was never called
+    void use_all_cores(bool all)
+    {
+        if (!_bound || all == _released)
+            return;
+        _released = all;
+
+#if defined(_WIN32)
+        SetThreadAffinityMask(GetCurrentThread(), all ? _original : 1);
+#elif defined(__APPLE__)
+        // the affinity policy is only a hint on macOS, there's nothing to release
+#elif !defined(PICOBENCH_DONT_BIND_TO_ONE_CORE)
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(0, &cpuset);
+
+        sched_setaffinity(0, sizeof(cpu_set_t), all ? &_original : &cpuset);
+#endif
+    }
+
+private:
+    bool _bound = false;
+    bool _released = false;
+#if defined(_WIN32)
+    DWORD_PTR _original = 0;
+#elif !defined(__APPLE__) && !defined(PICOBENCH_DONT_BIND_TO_ONE_CORE)
+    cpu_set_t _original;
+#endif
+};
+
+// just enough of a JSON parser to read back what report::to_json writes
+class json_value
+{
+public:
+    enum kind_t { null_v, bool_v, number_v, string_v, array_v, object_v };
+
+    kind_t kind = null_v;
+    double number = 0;              // also 1/0 for booleans
+    std::string str;
+    std::vector<json_value> items;  // array elements, or object values
+    std::vector<std::string> keys;  // object keys, matching items
+
+    const json_value* find(const char* key) const
+    {
+        if (kind != object_v) return nullptr;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i] == key)
+                return &items[i];
+        }
+        return nullptr;
+    }
+
+    static bool parse(const std::string& text, json_value& out)
+    {
+        const char* p = text.c_str();
+        if (!parse_value(p, out)) return false;
+        skip_space(p);
+        return *p == 0;
+    }
+
+private:
+    static void skip_space(const char*& p)
+    {
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') ++p;
+    }
+
+    static bool parse_string(const char*& p, std::string& out)
+    {
+        if (*p != '"') return false;
+        ++p;
+        while (*p && *p != '"')
+        {
+            if (*p == '\\')
+            {
+                ++p;
+                switch (*p)
+                {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                {
+                    // only code points below 0x80 survive; anything else becomes '?'
+                    unsigned code = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        const char h = *++p;
+                        if (!h) return false;
+                        code = code * 16 + unsigned(h >= 'a' ? h - 'a' + 10 : h >= 'A' ? h - 'A' + 10 : h - '0');
+                    }
+                    out += code < 0x80 ? char(code) : '?';
+                    break;
+                }
+                case 0: return false;
+                default: out += *p; break;
+                }
+                ++p;
+            }
+            else
+            {
+                out += *p++;
+            }
+        }
+        if (*p != '"') return false;
+        ++p;
+        return true;
+    }
+
+    static bool parse_value(const char*& p, json_value& out)
+    {
+        skip_space(p);
+        if (*p == '{')
+        {
+            out.kind = object_v;
+            ++p;
+            skip_space(p);
+            if (*p == '}') { ++p; return true; }
+            while (true)
+            {
+                skip_space(p);
+                out.keys.emplace_back();
+                if (!parse_string(p, out.keys.back())) return false;
+                skip_space(p);
+                if (*p++ != ':') return false;
+                out.items.emplace_back();
+                if (!parse_value(p, out.items.back())) return false;
+                skip_space(p);
+                if (*p == ',') { ++p; continue; }
+                if (*p == '}') { ++p; return true; }
+                return false;
+            }
+        }
+        if (*p == '[')
+        {
+            out.kind = array_v;
+            ++p;
+            skip_space(p);
+            if (*p == ']') { ++p; return true; }
+            while (true)
             {
-                auto& pvbs = res[d.dimension];
-                pvbs.push_back({ bm.name, bm.is_baseline, d.total_time_ns, d.result });
+                out.items.emplace_back();
+                if (!parse_value(p, out.items.back())) return false;
+                skip_space(p);
+                if (*p == ',') { ++p; continue; }
+                if (*p == ']') { ++p; return true; }
+                return false;
             }
         }
-        return res;
-    }
-
-private:
-
-    static void line(std::ostream& out)
-    {
-        for (int i = 0; i < 79; ++i) out.put('=');
-        out.put('\n');
+        if (*p == '"')
+        {
+            out.kind = string_v;
+            return parse_string(p, out.str);
+        }
+        if (strncmp(p, "true", 4) == 0) { out.kind = bool_v; out.number = 1; p += 4; return true; }
+        if (strncmp(p, "false", 5) == 0) { out.kind = bool_v; out.number = 0; p += 5; return true; }
+        if (strncmp(p, "null", 4) == 0) { out.kind = null_v; p += 4; return true; }
+
+        char* end = nullptr;
+        out.number = strtod(p, &end);
+        if (end == p) return false;
+        out.kind = number_v;
+        p = end;
+        return true;
     }
 };
 
@@ -734,7 +1902,8 @@ enum class report_output_format
 {
     text,
     concise_text,
-    csv
+    csv,
+    json
 };
 
 #if !defined(PICOBENCH_DEFAULT_ITERATIONS)
@@ -809,6 +1978,14 @@ public:
         {
             _suites = std::move(g_registry()._suites);
         }
+
+#if defined(__clang__)
+        add_context("compiler", "clang " __clang_version__);
+#elif defined(__GNUC__)
+        add_context("compiler", "gcc " __VERSION__);
+#elif defined(_MSC_VER)
+        add_context("compiler", "msvc " + std::to_string(_MSC_FULL_VER));
+#endif
     }
 
     int run(int benchmark_random_seed = -1)
@@ -841,11 +2018,131 @@ public:
             case picobench::report_output_format::csv:
                 report.to_csv(*out);
                 break;
+            case picobench::report_output_format::json:
+                report.to_json(*out);
+                break;
+            }
+
+            if (_json_file)
+            {
+                std::ofstream jout(_json_file);
+                if (!jout.is_open())
+                {
+                    std::cerr << "Error: Could not open output file `" << _json_file << "`\n";
+                    return 1;
+                }
+                report.to_json(jout);
             }
+
+            if (_compare_file)
+            {
+                compare_to_baseline(report, _compare_file);
+            }
+
+            _last_report = std::move(report);
         }
         return error();
     }
 
+    // the report produced by the last call to run(), for any further analysis
+    const report& last_report() const { return _last_report; }
+
+    // compares ns/op of the fastest sample of every row in the report against
+    // the same suite, benchmark and dimension in a json file written by an
+    // earlier run; rows slower by more than the tolerance set error_regression
+    bool compare_to_baseline(const report& rpt, const char* baseline_path) const
+    {
+        using namespace std;
+
+        ifstream fin(baseline_path);
+        json_value root;
+        const json_value* suites = nullptr;
+        if (fin.is_open())
+        {
+            stringstream text;
+            text << fin.rdbuf();
+            if (json_value::parse(text.str(), root))
+                suites = root.find("suites");
+        }
+        if (!suites || suites->kind != json_value::array_v)
+        {
+            *_stderr << "Error: Could not read baseline results from `" << baseline_path << "`\n";
+            _error = error_baseline_file;
+            return false;
+        }
+
+        auto& out = *_stdout;
+        out << "\nCompared with " << baseline_path << " (tolerance " << fixed << setprecision(1) << _compare_tolerance * 100.0 << "%):\n";
+
+        int compared = 0, regressions = 0;
+        for (auto& suite : rpt.suites)
+        {
+            const json_value* base_rows = nullptr;
+            for (auto& bs : suites->items)
+            {
+                auto name = bs.find("name");
+                if (name && (suite.name ? (name->kind == json_value::string_v && name->str == suite.name) : name->kind == json_value::null_v))
+                    base_rows = bs.find("rows");
+            }
+            if (!base_rows) continue;
+
+            for (auto& bm : suite.benchmarks)
+            {
+                for (auto& d : bm.data)
+                {
+                    const json_value* base_row = nullptr;
+                    for (auto& br : base_rows->items)
+                    {
+                        auto name = br.find("benchmark");
+                        auto dim = br.find("dimension");
+                        if (name && dim && name->str == bm.name && int(dim->number) == d.dimension)
+                            base_row = &br;
+                    }
+                    auto base_ns_op = base_row ? base_row->find("ns_per_op") : nullptr;
+                    if (!base_ns_op || base_ns_op->number <= 0) continue;
+
+                    const double ns_op = double(d.total_time_ns) / double(d.dimension);
+                    const double change = ns_op / base_ns_op->number - 1.0;
+                    const bool regressed = change > _compare_tolerance;
+
+                    ++compared;
+                    if (regressed) ++regressions;
+
+                    out << (regressed ? " !! " : "    ") << left
+                        << setw(36) << (string(suite.name ? suite.name : "") + " / " + bm.name)
+                        << " @" << setw(8) << d.dimension << right
+                        << setw(16) << setprecision(1) << base_ns_op->number << " ->"
+                        << setw(16) << ns_op << " ns/op"
+                        << setw(9) << showpos << change * 100.0 << noshowpos << "%\n";
+                }
+            }
+        }
+
+        out << compared << " rows compared, " << regressions << " slower than the baseline by more than "
+            << setprecision(1) << _compare_tolerance * 100.0 << "%\n";
+
+        if (regressions > 0)
+        {
+            _error = error_regression;
+            return false;
+        }
+        return true;
+    }
+
+    // adds or replaces a key/value describing the run, written to json reports
+    void add_context(const std::string& key, const std::string& value)
+    {
+        for (auto& kv : _context)
+        {
+            if (kv.first == key)
+            {
+                kv.second = value;
+                return;
+            }
+        }
+        _context.emplace_back(key, value);
+    }
+
     void run_benchmarks(int random_seed = -1)
     {
         I_PICOBENCH_ASSERT(_error == no_error && _should_run);
@@ -857,6 +2154,8 @@ public:
 
         std::minstd_rand rnd(random_seed);
 
+        apply_selection();
+
         // vector of all benchmarks
         std::vector<benchmark_impl*> benchmarks;
         for (auto& suite : _suites)
@@ -921,27 +2220,47 @@ public:
             b->_istate = b->_states.begin();
         }
 
-#if !defined(PICOBENCH_DONT_BIND_TO_ONE_CORE)
-        // set thread affinity to first cpu
-        // so the high resolution clock doesn't miss cycles
+        if (_collect_perf_counters)
         {
-#if defined(_WIN32)
-        SetThreadAffinityMask(GetCurrentThread(), 1);
-#elif defined(__APPLE__)
-        thread_affinity_policy_data_t policy = {0};
-        thread_policy_set(
-            pthread_mach_thread_np(pthread_self()),
-            THREAD_AFFINITY_POLICY,
-            (thread_policy_t)&policy, 1);
-#else
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(0, &cpuset);
-
-        sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
+            int opened = perf_counters::instance().open();
+            if (opened == 0)
+            {
+                *_stdwarn << "Warning: Hardware performance counters are unavailable"
+#if !defined(__linux__)
+                             " on this platform"
 #endif
+                             "; continuing without them.\n";
+            }
+            else if (opened < perf_values::num_counters)
+            {
+                *_stdwarn << "Warning: Only " << opened << " of " << int(perf_values::num_counters)
+                          << " hardware performance counters are available.\n";
+            }
+        }
+
+        if (_collect_memory)
+        {
+            memory_counters::instance().open(_allocation_counter, _allocation_peak_reset);
+        }
+
+        core_binding binding;
+        binding.bind();
+
+        // warmup runs aren't recorded; they let caches, branch predictors, the
+        // task system's thread pool and allocators settle before sampling
+        for (auto b : benchmarks)
+        {
+            const int warmup = b->_warmup < 0 ? _default_warmup : b->_warmup;
+            for (auto iters : state_iterations_for(*b))
+            {
+                binding.use_all_cores(b->_all_cores);
+                for (int i = 0; i < warmup; ++i)
+                {
+                    state ws(iters, -1, b->_user_data);
+                    b->_proc(ws);
+                }
+            }
         }
-#endif
 
         // we run a random benchmark from it incrementing _istate for each
         // when _istate reaches _states.end(), we erase the benchmark
@@ -951,15 +2270,23 @@ public:
             auto i = benchmarks.begin() + long(rnd() % benchmarks.size());
             auto& b = *i;
 
-            b->_proc(*b->_istate);
+            binding.use_all_cores(b->_all_cores);
+            run_sample(*b, *b->_istate);
 
             ++b->_istate;
 
-            if (b->_istate == b->_states.end())
+            // with a target confidence interval a benchmark that runs out of
+            // samples gets more, still drawn at random between the others
+            if (b->_istate == b->_states.end() && !add_ci_samples(*b))
             {
                 benchmarks.erase(i);
             }
         }
+
+        binding.use_all_cores(true);
+
+        perf_counters::instance().close();
+        memory_counters::instance().close();
     }
 
     // function to compare results
@@ -967,6 +2294,8 @@ public:
     report generate_report(CompareResult cmp = std::equal_to<result_t>()) const
     {
         report rpt;
+        rpt.show_stats = _show_stats;
+        rpt.context = _context;
 
         rpt.suites.resize(_suites.size());
         auto rpt_suite = rpt.suites.begin();
@@ -983,6 +2312,7 @@ public:
             {
                 rpt_benchmark->name = b->_name;
                 rpt_benchmark->is_baseline = b->_baseline;
+                rpt_benchmark->all_cores = b->_all_cores;
 
                 const std::vector<int>& state_iterations =
                     b->_state_iterations.empty() ?
@@ -992,7 +2322,11 @@ public:
                 rpt_benchmark->data.reserve(state_iterations.size());
                 for (auto d : state_iterations)
                 {
-                    rpt_benchmark->data.push_back({ d, 0, 0ll });
+                    report::benchmark_problem_space space;
+                    space.dimension = d;
+                    if (b->_work)
+                        space.work = b->_work(d);
+                    rpt_benchmark->data.push_back(space);
                 }
 
                 for (auto& state : b->_states)
@@ -1005,6 +2339,13 @@ public:
                             {
                                 d.total_time_ns = state.duration_ns();
                                 d.result = state.result();
+                                d.perf = state.perf();
+                            }
+
+                            // keep the worst of any samples that checked their output
+                            if (state.accuracy().valid && (!d.accuracy.valid || state.accuracy().psnr < d.accuracy.psnr))
+                            {
+                                d.accuracy = state.accuracy();
                             }
 
                             if (_compare_results_across_samples)
@@ -1022,12 +2363,38 @@ public:
                     }
                 }
 
-#if defined(PICOBENCH_DEBUG)
                 for (auto& d : rpt_benchmark->data)
                 {
-                    I_PICOBENCH_ASSERT(d.samples == b->_samples);
+                    std::vector<int64_t> times;
+                    for (auto& state : b->_states)
+                    {
+                        if (state.iterations() == d.dimension)
+                            times.push_back(state.duration_ns());
+                    }
+                    d.stats = sample_stats::from(std::move(times));
+
+                    std::vector<memory_values> inside, outside;
+                    for (auto& state : b->_states)
+                    {
+                        if (state.iterations() == d.dimension)
+                        {
+                            inside.push_back(state.memory());
+                            outside.push_back(state.memory_outside());
+                        }
+                    }
+                    d.memory = memory_values::mean(inside);
+                    d.memory_outside = memory_values::mean(outside);
+
+                    // adaptive sampling can only add samples
+                    I_PICOBENCH_ASSERT(d.samples >= b->_samples);
+
+                    if (d.accuracy.failed())
+                    {
+                        *_stderr << "Error: " << b->name() << " @" << d.dimension << " is too far from its reference: max error "
+                                 << d.accuracy.max_abs_error << ", PSNR " << d.accuracy.psnr << " dB\n";
+                        _error = error_accuracy;
+                    }
                 }
-#endif
 
                 ++rpt_benchmark;
             }
@@ -1120,8 +2487,17 @@ public:
             _opts.emplace_back("-samples=", "<n>",
                 "Sets default number of samples for benchmarks",
                 &runner::cmd_samples);
-            _opts.emplace_back("-out-fmt=", "<txt|con|csv>",
-                "Outputs text or concise or csv",
+            _opts.emplace_back("-filter=", "<regex>",
+                "Runs only benchmarks whose suite/name matches",
+                &runner::cmd_filter);
+            _opts.emplace_back("-suite-iters=", "<re>:<n,...>",
+                "Sets iterations for suites matching the regex",
+                &runner::cmd_suite_iters);
+            _opts.emplace_back("-suite-samples=", "<re>:<n>",
+                "Sets samples for suites matching the regex",
+                &runner::cmd_suite_samples);
+            _opts.emplace_back("-out-fmt=", "<txt|con|csv|json>",
+                "Outputs text or concise or csv or json",
                 &runner::cmd_out_fmt);
             _opts.emplace_back("-output=", "<filename>",
                 "Sets output filename or `stdout`",
@@ -1129,6 +2505,33 @@ public:
             _opts.emplace_back("-compare-results", "",
                 "Compare benchmark results",
                 &runner::cmd_compare_results);
+            _opts.emplace_back("-perf", "",
+                "Collect hardware counters (Linux)",
+                &runner::cmd_perf);
+            _opts.emplace_back("-mem", "",
+                "Collect page faults and allocations",
+                &runner::cmd_mem);
+            _opts.emplace_back("-warmup=", "<n>",
+                "Unrecorded runs before sampling",
+                &runner::cmd_warmup);
+            _opts.emplace_back("-ci=", "<pct>",
+                "Sample until the 95% CI is within pct% of the mean",
+                &runner::cmd_ci);
+            _opts.emplace_back("-max-samples=", "<n>",
+                "Most samples to take with -ci (default 30)",
+                &runner::cmd_max_samples);
+            _opts.emplace_back("-stats", "",
+                "Show median, p90, p99, stddev and CI",
+                &runner::cmd_stats);
+            _opts.emplace_back("-json=", "<filename>",
+                "Also writes json results to a file",
+                &runner::cmd_json);
+            _opts.emplace_back("-compare=", "<baseline.json>",
+                "Fails if slower than an earlier json run",
+                &runner::cmd_compare);
+            _opts.emplace_back("-tolerance=", "<pct>",
+                "Allowed slowdown for -compare (default 5)",
+                &runner::cmd_tolerance);
             _opts.emplace_back("-no-run", "",
                 "Doesn't run benchmarks",
                 &runner::cmd_no_run);
@@ -1211,15 +2614,125 @@ public:
     void set_compare_results_across_benchmarks(bool b) { _compare_results_across_benchmarks = b; }
     bool compare_results_across_benchmarks() const { return _compare_results_across_benchmarks; }
 
+    void set_collect_perf_counters(bool b) { _collect_perf_counters = b; }
+    bool collect_perf_counters() const { return _collect_perf_counters; }
+
+    void set_collect_memory(bool b) { _collect_memory = b; }
+    bool collect_memory() const { return _collect_memory; }
+
+    // lets -mem count the program's allocations, which picobench can't see
+    void set_allocation_counter(allocation_counter counter, allocation_peak_reset reset = nullptr)
+    {
+        _allocation_counter = counter;
+        _allocation_peak_reset = reset;
+    }
+
+    // unrecorded runs of each benchmark at each dimension before sampling
+    void set_default_warmup(int n) { _default_warmup = n; }
+    int default_warmup() const { return _default_warmup; }
+
+    // keep sampling each benchmark at each dimension until the 95% confidence
+    // interval of the mean is within this fraction of it (0 disables), taking
+    // at most max_samples; also turns on the statistics columns
+    void set_target_ci(double ci, int max_samples)
+    {
+        _target_ci = ci;
+        _max_samples = max_samples;
+        if (ci > 0) _show_stats = true;
+    }
+    double target_ci() const { return _target_ci; }
+    int max_samples() const { return _max_samples; }
+
+    void set_show_stats(bool b) { _show_stats = b; }
+    bool show_stats() const { return _show_stats; }
+
+    // also write a json report to this file, whatever the preferred format
+    void set_json_output_filename(const char* path) { _json_file = path; }
+    const char* json_output_filename() const { return _json_file; }
+
+    // after running, compare against a json report from an earlier run;
+    // tolerance is the fraction slower a row may be before it's a regression
+    void set_compare_baseline(const char* path, double tolerance)
+    {
+        _compare_file = path;
+        _compare_tolerance = tolerance;
+    }
+    const char* compare_baseline() const { return _compare_file; }
+    double compare_tolerance() const { return _compare_tolerance; }
+
+    // only run benchmarks where "suite/name" matches this (ECMAScript) regex;
+    // returns false, leaving the filter alone, if it doesn't compile
+    bool set_filter(const char* regex)
+    {
+        try
+        {
+            _filter = std::regex(regex);
+        }
+        catch (const std::regex_error&)
+        {
+            return false;
+        }
+        _has_filter = true;
+        return true;
+    }
+
+    // replace the iterations (if not empty) and samples (if not 0) of every
+    // benchmark in suites whose name matches the regex, whatever they set
+    // themselves; later overrides win. returns false if the regex doesn't compile
+    bool add_suite_override(const char* suite_regex, std::vector<int> iterations, int samples)
+    {
+        suite_override o;
+        try
+        {
+            o.suite = std::regex(suite_regex);
+        }
+        catch (const std::regex_error&)
+        {
+            return false;
+        }
+        o.iterations = std::move(iterations);
+        o.samples = samples;
+        _suite_overrides.push_back(std::move(o));
+        return true;
+    }
+
 private:
     // runner's suites and benchmarks come from its parent: registry
 
     // state and configuration
     mutable error_t _error = no_error;
+
+    report _last_report;
+
     bool _should_run = true;
 
     bool _compare_results_across_samples = false;
     bool _compare_results_across_benchmarks = false;
+    bool _collect_perf_counters = false;
+    bool _collect_memory = false;
+    allocation_counter _allocation_counter = nullptr;
+    allocation_peak_reset _allocation_peak_reset = nullptr;
+    bool _show_stats = false;
+
+    int _default_warmup = 0;
+    double _target_ci = 0;
+    int _max_samples = 30;
+
+    bool _has_filter = false;
+    std::regex _filter;
+
+    struct suite_override
+    {
+        std::regex suite;
+        std::vector<int> iterations;
+        int samples = 0;
+    };
+    std::vector<suite_override> _suite_overrides;
+
+    std::vector<std::pair<std::string, std::string>> _context;
+    const char* _json_file = nullptr;
+    const char* _compare_file = nullptr;
+    double _compare_tolerance = 0.05;
 
     report_output_format _output_format = report_output_format::text;
     const char* _output_file = nullptr; // nullptr means stdout
@@ -1236,6 +2749,88 @@ private:
     // default samples per benchmark
     int _default_samples;
 
+    const std::vector<int>& state_iterations_for(const benchmark_impl& b) const
+    {
+        return b._state_iterations.empty() ? _default_state_iterations : b._state_iterations;
+    }
+
+    // queues one more sample at each dimension whose confidence interval of
+    // the mean is still wider than the target, up to max_samples, and points
+    // _istate at them; false once every dimension is done
+    bool add_ci_samples(benchmark_impl& b) const
+    {
+        if (!(_target_ci > 0)) return false;
+
+        const size_t first = b._states.size();
+        for (auto iters : state_iterations_for(b))
+        {
+            std::vector<int64_t> times;
+            for (auto& st : b._states)
+            {
+                if (st.iterations() == iters)
+                    times.push_back(st.duration_ns());
+            }
+
+            if (int(times.size()) < _max_samples && !(sample_stats::from(times).ci <= _target_ci))
+                b._states.emplace_back(iters, int(times.size()), b._user_data);
+        }
+
+        b._istate = b._states.begin() + long(first);
+        return b._states.size() > first;
+    }
+
+    // runs one sample, reading memory activity around the whole benchmark
+    // function so what happens outside the timer can be told apart
+    static void run_sample(const benchmark_impl& b, state& s)
+    {
+        memory_counters::instance().reset_peak();
+
+        memory_values begin;
+        const bool memory = read_memory_values(begin);
+
+        b._proc(s);
+
+        memory_values end;
+        if (memory && read_memory_values(end))
+            s._memory_sample = memory_values::between(begin, end);
+    }
+
+    // removes benchmarks the filter doesn't match (and suites left empty),
+    // then applies the per-suite overrides to what remains
+    void apply_selection()
+    {
+        for (auto& suite : _suites)
+        {
+            const std::string suite_name = suite.name ? suite.name : "";
+
+            if (_has_filter)
+            {
+                auto& bms = suite.benchmarks;
+                bms.erase(std::remove_if(bms.begin(), bms.end(), [&](const std::unique_ptr<benchmark_impl>& b) {
+                    return !std::regex_search(suite_name + "/" + b->name(), _filter);
+                }), bms.end());
+            }
+
+            for (auto& o : _suite_overrides)
+            {
+                if (!std::regex_search(suite_name, o.suite))
+                    continue;
+
+                for (auto& b : suite.benchmarks)
+                {
+                    if (!o.iterations.empty())
+                        b->_state_iterations = o.iterations;
+                    if (o.samples > 0)
+                        b->_samples = o.samples;
+                }
+            }
+        }
+
+        _suites.erase(std::remove_if(_suites.begin(), _suites.end(), [](const rsuite& suite) {
+            return suite.benchmarks.empty();
+        }), _suites.end());
+    }
+
     // command line parsing
     picostring _cmd_prefix;
     typedef bool (runner::*cmd_handler)(const char*); // internal handler
@@ -1261,9 +2856,8 @@ private:
     bool _has_opts = false; // have opts been added to list
     std::vector<cmd_line_option> _opts;
 
-    bool cmd_iters(const char* line)
+    static bool parse_iters(const char* line, std::vector<int>& iters)
     {
-        std::vector<int> iters;
         auto p = line;
         while (true)
         {
@@ -1274,7 +2868,13 @@ private:
             if (!p) break;
             ++p;
         }
-        if (iters.empty()) return false;
+        return !iters.empty();
+    }
+
+    bool cmd_iters(const char* line)
+    {
+        std::vector<int> iters;
+        if (!parse_iters(line, iters)) return false;
         _default_state_iterations = iters;
         return true;
     }
@@ -1335,6 +2935,10 @@ private:
         {
             _output_format = report_output_format::csv;
         }
+        else if (strcmp(line, "json") == 0)
+        {
+            _output_format = report_output_format::json;
+        }
         else
         {
             return false;
@@ -1362,6 +2966,114 @@ private:
         _compare_results_across_benchmarks = true;
         return true;
     }
+
+    bool cmd_perf(const char* line)
+    {
+        if (*line) return false;
+        _collect_perf_counters = true;
+        return true;
+    }
+
+    bool cmd_mem(const char* line)
+    {
+        if (*line) return false;
+        _collect_memory = true;
+        return true;
+    }
+
+    bool cmd_warmup(const char* line)
+    {
+        char* end = nullptr;
+        int warmup = int(strtol(line, &end, 10));
+        if (end == line || *end || warmup < 0) return false;
+        _default_warmup = warmup;
+        return true;
+    }
+
+    bool cmd_ci(const char* line)
+    {
+        char* end = nullptr;
+        double pct = strtod(line, &end);
+        if (end == line || *end || pct <= 0) return false;
+        _target_ci = pct / 100.0;
+        _show_stats = true;
+        return true;
+    }
+
+    bool cmd_max_samples(const char* line)
+    {
+        char* end = nullptr;
+        long samples = strtol(line, &end, 10);
+        if (end == line || *end || samples <= 0 || samples > std::numeric_limits<int>::max()) return false;
+        _max_samples = int(samples);
+        return true;
+    }
+
+    bool cmd_stats(const char* line)
+    {
+        if (*line) return false;
+        _show_stats = true;
+        return true;
+    }
+
+    bool cmd_json(const char* line)
+    {
+        if (!*line) return false;
+        _json_file = line;
+        return true;
+    }
+
+    bool cmd_compare(const char* line)
+    {
+        if (!*line) return false;
+        _compare_file = line;
+        return true;
+    }
+
+    bool cmd_tolerance(const char* line)
+    {
+        char* end = nullptr;
+        double pct = strtod(line, &end);
+        if (end == line || *end || pct < 0) return false;
+        _compare_tolerance = pct / 100.0;
+        return true;
+    }
+
+    bool cmd_filter(const char* line)
+    {
+        if (!*line) return false;
+        return set_filter(line);
+    }
+
+    // <regex>:<value>; split on the last ':' so the regex may contain them
+    static bool split_suite_arg(const char* line, std::string& regex, const char*& value)
+    {
+        auto colon = strrchr(line, ':');
+        if (!colon || colon == line || !colon[1]) return false;
+        regex.assign(line, colon);
+        value = colon + 1;
+        return true;
+    }
+
+    bool cmd_suite_iters(const char* line)
+    {
+        std::string regex;
+        const char* value;
+        std::vector<int> iters;
+        if (!split_suite_arg(line, regex, value) || !parse_iters(value, iters)) return false;
+        return add_suite_override(regex.c_str(), std::move(iters), 0);
+    }
+
+    bool cmd_suite_samples(const char* line)
+    {
+        std::string regex;
+        const char* value;
+        if (!split_suite_arg(line, regex, value)) return false;
+        char* end = nullptr;
+        int samples = int(strtol(value, &end, 10));
+        if (*end || samples <= 0) return false;
+        return add_suite_override(regex.c_str(), {}, samples);
+    }
 };
 
 class local_runner : public runner
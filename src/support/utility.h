@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cstdlib>
+#include <atomic>
 #include <cmath>
 #include <cfloat>
 #include <memory>
@@ -25,6 +26,9 @@ inline uint64_t _u64_rand() { return __rdtsc(); }
 #else
 #include <sys/time.h>
 #include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
 inline uint64_t _u64_rand() 
 {
     struct timeval tv;
@@ -36,24 +40,74 @@ inline uint64_t _u64_rand()
 // ---------------------------------------------------------------------------------------------------------------------
 namespace utils
 {
+    // running totals of allocateAlign16 calls, so the benchmarks can report allocation traffic alongside page faults,
+    // plus the bytes currently live and their high-water mark since the last resetAllocationPeak();
+    // not static, so every translation unit shares the one set of counters
+    struct AllocationCounters
+    {
+        std::atomic< uint64_t > allocations { 0 };
+        std::atomic< uint64_t > bytes { 0 };
+        std::atomic< uint64_t > liveBytes { 0 };
+        std::atomic< uint64_t > peakLiveBytes { 0 };
+    };
+    inline AllocationCounters& allocationCounters()
+    {
+        static AllocationCounters counters;
+        return counters;
+    }
+
+    inline void readAllocationCounters( uint64_t& allocations, uint64_t& bytes, uint64_t& peakLiveBytes )
+    {
+        allocations   = allocationCounters().allocations.load( std::memory_order_relaxed );
+        bytes         = allocationCounters().bytes.load( std::memory_order_relaxed );
+        peakLiveBytes = allocationCounters().peakLiveBytes.load( std::memory_order_relaxed );
+    }
+
+    inline void resetAllocationPeak()
+    {
+        allocationCounters().peakLiveBytes.store( allocationCounters().liveBytes.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    }
+
+    // each block starts with a header holding its size, so freeAlign16 can take it back off the live total; 16 bytes
+    // keeps the data that follows it aligned
+    static constexpr size_t c_allocationHeaderBytes = 16;
+
     // allocate numElements of _T aligned to 16 bytes
     template< typename _T >
     inline static _T* allocateAlign16( const size_t numElements )
     {
+        const uint64_t size = sizeof( _T ) * numElements;
+
+        AllocationCounters& counters = allocationCounters();
+        counters.allocations.fetch_add( 1, std::memory_order_relaxed );
+        counters.bytes.fetch_add( size, std::memory_order_relaxed );
+
+        const uint64_t live = counters.liveBytes.fetch_add( size, std::memory_order_relaxed ) + size;
+        uint64_t peak = counters.peakLiveBytes.load( std::memory_order_relaxed );
+        while ( live > peak && !counters.peakLiveBytes.compare_exchange_weak( peak, live, std::memory_order_relaxed ) ) {}
+
 #ifdef WIN32
-        return reinterpret_cast<_T*>(_aligned_malloc( sizeof( _T ) * numElements, 16 ));
+        uint8_t* block = reinterpret_cast<uint8_t*>(_aligned_malloc( c_allocationHeaderBytes + size, 16 ));
 #else
-        return reinterpret_cast<_T*>(aligned_alloc( 16, sizeof( _T ) * numElements ));
+        uint8_t* block = reinterpret_cast<uint8_t*>(aligned_alloc( 16, c_allocationHeaderBytes + size ));
 #endif
+        *reinterpret_cast<uint64_t*>( block ) = size;
+        return reinterpret_cast<_T*>( block + c_allocationHeaderBytes );
     }
 
     // free memory allocated with allocateAlign16
     inline static void freeAlign16( void* ptr )
     {
+        if ( ptr == nullptr )
+            return;
+
+        uint8_t* block = reinterpret_cast<uint8_t*>( ptr ) - c_allocationHeaderBytes;
+        allocationCounters().liveBytes.fetch_sub( *reinterpret_cast<const uint64_t*>( block ), std::memory_order_relaxed );
+
 #ifdef WIN32
-        return _aligned_free( ptr );
+        return _aligned_free( block );
 #else
-        return free( ptr );
+        return free( block );
 #endif
     }
 
@@ -70,6 +124,115 @@ namespace utils
         return value;
     }
 
+    // human-readable name of the host CPU; the CPUID brand string on x86, /proc/cpuinfo elsewhere on Linux
+    inline static std::string hostCPUName()
+    {
+        std::string name;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        uint32_t brand[12] = { 0 };
+#ifdef WIN32
+        int regs[4];
+        __cpuid( regs, 0x80000000 );
+        if ( (uint32_t)regs[0] >= 0x80000004 )
+        {
+            for ( int leaf = 0; leaf < 3; leaf++ )
+                __cpuid( reinterpret_cast<int*>( brand + ( leaf * 4 ) ), 0x80000002 + leaf );
+        }
+#else
+        if ( __get_cpuid_max( 0x80000000, nullptr ) >= 0x80000004 )
+        {
+            for ( uint32_t leaf = 0; leaf < 3; leaf++ )
+                __get_cpuid( 0x80000002 + leaf, &brand[leaf * 4], &brand[leaf * 4 + 1], &brand[leaf * 4 + 2], &brand[leaf * 4 + 3] );
+        }
+#endif
+        name.assign( reinterpret_cast<const char*>( brand ), strnlen( reinterpret_cast<const char*>( brand ), sizeof( brand ) ) );
+#elif defined(__linux__)
+        // ARM kernels report 'model name' per core on some versions, 'Model' for the board on others (eg. Raspberry Pi)
+        if ( FILE* cpuinfo = fopen( "/proc/cpuinfo", "r" ) )
+        {
+            char line[256];
+            while ( fgets( line, sizeof( line ), cpuinfo ) )
+            {
+                if ( strncmp( line, "model name", 10 ) == 0 || strncmp( line, "Model", 5 ) == 0 )
+                {
+                    const char* value = strchr( line, ':' );
+                    if ( value )
+                    {
+                        name = value + 1;
+                        name.erase( name.find_last_not_of( " \t\r\n" ) + 1 );
+                    }
+                    break;
+                }
+            }
+            fclose( cpuinfo );
+        }
+#endif
+
+        // brand strings are often padded with leading spaces
+        const size_t start = name.find_first_not_of( ' ' );
+        return ( start == std::string::npos ) ? std::string( "unknown" ) : name.substr( start );
+    }
+
+    // how far an output buffer is from a reference buffer of the same size
+    struct OutputError
+    {
+        double  maxAbsError;    // largest difference of any one value
+        double  psnr;           // peak signal to noise ratio in dB; infinite if the two are identical
+    };
+
+    inline static double psnrFromSquaredError( const double sumSquaredError, const size_t count, const double peak )
+    {
+        if ( sumSquaredError <= 0.0 || count == 0 )
+            return INFINITY;
+
+        const double mse = sumSquaredError / (double)count;
+        return 10.0 * std::log10( ( peak * peak ) / mse );
+    }
+
+    // float outputs; the peak is the range the reference covers, so distances, audio and [0..1] images all compare
+    // on the same footing
+    inline static OutputError compareOutput( const float* output, const float* reference, const size_t count )
+    {
+        double maxAbsError = 0.0, sumSquaredError = 0.0;
+        float lo = FLT_MAX, hi = -FLT_MAX;
+
+        for ( size_t i = 0; i < count; i++ )
+        {
+            const double diff = std::abs( (double)output[i] - (double)reference[i] );
+
+            maxAbsError      = ( diff > maxAbsError || std::isnan( diff ) ) ? diff : maxAbsError;
+            sumSquaredError += diff * diff;
+
+            lo = ( reference[i] < lo ) ? reference[i] : lo;
+            hi = ( reference[i] > hi ) ? reference[i] : hi;
+        }
+
+        const double peak = ( hi > lo ) ? (double)( hi - lo ) : 1.0;
+        return { maxAbsError, psnrFromSquaredError( sumSquaredError, count, peak ) };
+    }
+
+    // packed 8-bit RGBA pixels, compared per channel against a peak of 255
+    inline static OutputError compareOutput( const uint32_t* output, const uint32_t* reference, const size_t count )
+    {
+        double maxAbsError = 0.0, sumSquaredError = 0.0;
+
+        for ( size_t i = 0; i < count; i++ )
+        {
+            for ( uint32_t shift = 0; shift < 32; shift += 8 )
+            {
+                const int32_t a = (int32_t)( ( output[i] >> shift ) & 0xFF );
+                const int32_t b = (int32_t)( ( reference[i] >> shift ) & 0xFF );
+                const double diff = (double)std::abs( a - b );
+
+                maxAbsError      = ( diff > maxAbsError ) ? diff : maxAbsError;
+                sumSquaredError += diff * diff;
+            }
+        }
+
+        return { maxAbsError, psnrFromSquaredError( sumSquaredError, count * 4, 255.0 ) };
+    }
+
     // https://stackoverflow.com/questions/2342162/stdstring-formatting-like-sprintf
     template<typename ... Args>
     std::string stringFormat( const char* format, Args ... args )
@@ -94,6 +257,13 @@ inline uint64_t _memory_rand_offset() { return 16 * (utils::randomU64() & 0xFFFF
 // ---------------------------------------------------------------------------------------------------------------------
 namespace container
 {
+    // global switch for saveToPNG / saveToWAV, so timing-only runs don't spend their time on disk
+    inline bool& outputFilesEnabled()
+    {
+        static bool enabled = true;
+        return enabled;
+    }
+
     // simple 1D float buffer, aligned on 16b
     struct AlignedFloatBuffer
     {
@@ -154,6 +324,9 @@ namespace container
 
         inline void saveToPNG( const char* nametag, const uint32_t iteration ) const
         {
+            if ( !outputFilesEnabled() )
+                return;
+
             const std::string pngPath = utils::stringFormat( "%s_[%02u]_%ux%u.png", nametag, iteration, m_width, m_height );
 
             int32_t writeError = stbi_write_png( pngPath.c_str(), m_width, m_height, 4, m_data, sizeof( uint32_t ) * m_width );
@@ -217,6 +390,9 @@ namespace container
 
         inline bool saveToWAV( const char* nametag, const uint32_t iteration ) const
         {
+            if ( !outputFilesEnabled() )
+                return true;
+
             const std::string wavPath = utils::stringFormat( "%s_[%02u sec]_%u_%ic.wav", nametag, iteration, _sampleRate, _channels );
 
 #ifdef WIN32
@@ -44,6 +44,7 @@
     - Microsoft's Concurrency Runtime (ISPC_USE_CONCRT)
     - Apple's Grand Central Dispatch (ISPC_USE_GCD)
     - bare pthreads (ISPC_USE_PTHREADS, ISPC_USE_PTHREADS_FULLY_SUBSCRIBED)
+    - pthreads with per-thread work-stealing deques (ISPC_USE_WORK_STEALING)
     - TBB (ISPC_USE_TBB_TASK_GROUP, ISPC_USE_TBB_PARALLEL_FOR)
     - OpenMP (ISPC_USE_OMP)
     - HPX (ISPC_USE_HPX)
@@ -58,6 +59,7 @@
 #define ISPC_USE_CONCRT
 #define ISPC_USE_PTHREADS
 #define ISPC_USE_PTHREADS_FULLY_SUBSCRIBED
+#define ISPC_USE_WORK_STEALING
 #define ISPC_USE_OMP
 #define ISPC_USE_TBB_TASK_GROUP
 #define ISPC_USE_TBB_PARALLEL_FOR
@@ -67,6 +69,12 @@
   for task management.  This model is useful for KNC where tasks can take over
   the machine, but less so when there are other tasks that need running on the machine.
 
+  The ISPC_USE_WORK_STEALING model gives every thread its own lock-free
+  Chase-Lev deque.  A launch pushes a single range of task indices; threads
+  that pick a range up split it in half, keep one half and leave the other
+  to be stolen.  There is no global lock on the path that hands out tasks,
+  which matters when a launch contains thousands of small tiles.
+
 #define ISPC_USE_CREW
 #define ISPC_USE_HPX
   The HPX model requires the HPX runtime environment to be set up. This can be
@@ -79,7 +87,8 @@
 
 #if !(defined ISPC_USE_CONCRT || defined ISPC_USE_GCD || defined ISPC_USE_PTHREADS ||                                  \
       defined ISPC_USE_PTHREADS_FULLY_SUBSCRIBED || defined ISPC_USE_TBB_TASK_GROUP ||                                 \
-      defined ISPC_USE_TBB_PARALLEL_FOR || defined ISPC_USE_OMP || defined ISPC_USE_HPX)
+      defined ISPC_USE_TBB_PARALLEL_FOR || defined ISPC_USE_OMP || defined ISPC_USE_HPX ||                           \
+      defined ISPC_USE_WORK_STEALING)
 
 // If no task model chosen from the compiler cmdline, pick a reasonable default
 #if defined(_WIN32) || defined(_WIN64)
@@ -103,6 +112,7 @@
 
 #ifdef ISPC_IS_WINDOWS
 #define NOMINMAX
+#include <intrin.h>
 #include <windows.h>
 #endif // ISPC_IS_WINDOWS
 #ifdef ISPC_USE_CONCRT
@@ -139,6 +149,13 @@ using namespace Concurrency;
 //#include <stdexcept>
 #include <stack>
 #endif // ISPC_USE_PTHREADS_FULLY_SUBSCRIBED
+#ifdef ISPC_USE_WORK_STEALING
+#include <atomic>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif // ISPC_USE_WORK_STEALING
 #ifdef ISPC_USE_TBB_PARALLEL_FOR
 #include <tbb/parallel_for.h>
 #endif // ISPC_USE_TBB_PARALLEL_FOR
@@ -155,6 +172,9 @@ using namespace Concurrency;
 #ifdef ISPC_IS_LINUX
 #include <stdlib.h>
 #endif // ISPC_IS_LINUX
+#if defined(ISPC_IS_LINUX) || defined(ISPC_IS_APPLE)
+#include <sys/mman.h>
+#endif // ISPC_IS_LINUX || ISPC_IS_APPLE
 
 #include <algorithm>
 #include <assert.h>
@@ -162,6 +182,21 @@ using namespace Concurrency;
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "tasksys.h"
+
+#if defined(ISPC_USE_PTHREADS) || defined(ISPC_USE_WORK_STEALING) || defined(ISPC_USE_PTHREADS_FULLY_SUBSCRIBED)
+#define ISPC_USE_THREAD_POOL
+#endif
+
+// Task systems that hand out ranges of a launch, rather than scheduling
+// each task individually, only need a single TaskInfo per launch.
+#if defined(ISPC_USE_PTHREADS) || defined(ISPC_USE_WORK_STEALING)
+#define ISPC_USE_LAUNCH_RANGES
+#endif
 
 // Signature of ispc-generated 'task' functions
 typedef void (*TaskFuncType)(void *data, int threadIndex, int threadCount, int taskIndex, int taskCount, int taskIndex0,
@@ -184,6 +219,14 @@ struct TaskInfo {
     int taskCount1() const { return taskCount3d[1]; }
     int taskCount2() const { return taskCount3d[2]; }
     TaskInfo() = default;
+
+    /** Run task number 'index' of the launch described by this TaskInfo
+        (whose own taskIndex is ignored). */
+    void Run(int index, int threadIndex, int threadCount) const {
+        func(data, threadIndex, threadCount, index, taskCount(), index % taskCount3d[0],
+             (index / taskCount3d[0]) % taskCount3d[1], index / (taskCount3d[0] * taskCount3d[1]), taskCount0(),
+             taskCount1(), taskCount2());
+    }
 };
 
 // ispc expects these functions to have C linkage / not be mangled
@@ -193,16 +236,215 @@ void *ISPCAlloc(void **handlePtr, int64_t size, int32_t alignment);
 void ISPCSync(void *handle);
 }
 
+///////////////////////////////////////////////////////////////////////////
+// Statistics (see tasksys.h)
+
+/* Counters are kept per thread and only ever written by their owner, so
+   the hot paths don't contend on shared cache lines; GetTaskSystemStats()
+   sums them across every thread that has touched the task system.
+ */
+struct TaskThreadStats {
+    std::atomic<uint64_t> launches{0};
+    std::atomic<uint64_t> tasks{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocatedBytes{0};
+    std::atomic<uint64_t> arenaBlocks{0};
+    std::atomic<uint64_t> largePageBlocks{0};
+    std::atomic<int64_t> arenaBytes{0};
+    TaskThreadStats *next = NULL;
+
+    static inline void Bump(std::atomic<uint64_t> &counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+};
+
+static std::atomic<TaskThreadStats *> allThreadStats(NULL);
+static thread_local TaskThreadStats *tlsThreadStats = NULL;
+
+static inline TaskThreadStats &lThreadStats() {
+    if (tlsThreadStats == NULL) {
+        // Registered for the life of the process, so counts from threads
+        // that have since exited still show up in the totals.
+        TaskThreadStats *stats = new TaskThreadStats;
+        stats->next = allThreadStats.load();
+        while (!allThreadStats.compare_exchange_weak(stats->next, stats))
+            ;
+        tlsThreadStats = stats;
+    }
+    return *tlsThreadStats;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// TaskArena
+
+/* ISPCAlloc() memory is carved from a bump allocator owned by the thread
+   making the call.  The generated code always allocates and syncs a task
+   group on the same thread, and groups are synced in the reverse order to
+   which they first allocated (they follow the call stack), so each group
+   only needs to remember where the arena was when it started and can hand
+   everything back in one go when it is reset.
+
+   Blocks are kept once allocated, so a steady launch pattern (e.g. the
+   same kernels every frame) settles down to reusing the same, already
+   faulted-in, memory with no allocator traffic at all.  Blocks are
+   TASK_ARENA_BLOCK_SIZE bytes and ask for large pages where the OS offers
+   them.
+ */
+
+#define TASK_ARENA_BLOCK_SIZE (2 << 20)
+
+struct TaskArenaMark {
+    int block;
+    size_t offset;
+};
+
+class TaskArena {
+  public:
+    ~TaskArena() {
+        for (size_t i = 0; i < blocks.size(); ++i)
+            FreeBlock(blocks[i]);
+    }
+
+    TaskArenaMark Mark() const {
+        TaskArenaMark m = {curBlock, curOffset};
+        return m;
+    }
+
+    void Release(const TaskArenaMark &m) {
+        assert(m.block < curBlock || (m.block == curBlock && m.offset <= curOffset));
+        curBlock = m.block;
+        curOffset = m.offset;
+    }
+
+    void *Alloc(int64_t size, int32_t alignment) {
+        while (1) {
+            if (curBlock < (int)blocks.size()) {
+                Block &b = blocks[curBlock];
+                uintptr_t start = ((uintptr_t)b.base + curOffset + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+                size_t end = (size_t)(start - (uintptr_t)b.base) + (size_t)size;
+                if (end <= b.size) {
+                    curOffset = end;
+                    return (void *)start;
+                }
+
+                // Doesn't fit; move on to the next block, if it's big enough
+                if (curBlock + 1 < (int)blocks.size() && blocks[curBlock + 1].size >= (size_t)(size + alignment)) {
+                    ++curBlock;
+                    curOffset = 0;
+                    continue;
+                }
+                ++curBlock;
+            }
+
+            // Insert a fresh block here; any (smaller) blocks after it stay
+            // around for reuse.
+            blocks.insert(blocks.begin() + curBlock, AllocBlock((size_t)(size + alignment)));
+            curOffset = 0;
+        }
+    }
+
+  private:
+    struct Block {
+        char *base;
+        size_t size;
+        bool largePages;
+    };
+
+    static Block AllocBlock(size_t minSize) {
+        Block b;
+        b.size = std::max(minSize, (size_t)TASK_ARENA_BLOCK_SIZE);
+        b.size = (b.size + TASK_ARENA_BLOCK_SIZE - 1) & ~(size_t)(TASK_ARENA_BLOCK_SIZE - 1);
+        b.largePages = false;
+#if defined(ISPC_IS_WINDOWS)
+        // Large pages need SeLockMemoryPrivilege; quietly fall back if we don't have it
+        SIZE_T largePage = GetLargePageMinimum();
+        b.base = NULL;
+        if (largePage != 0 && (b.size % largePage) == 0) {
+            b.base = (char *)VirtualAlloc(NULL, b.size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            b.largePages = (b.base != NULL);
+        }
+        if (b.base == NULL)
+            b.base = (char *)VirtualAlloc(NULL, b.size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(ISPC_IS_LINUX) || defined(ISPC_IS_APPLE)
+        // Over-map so the block can be aligned to the large page size, which
+        // transparent huge pages need in order to back it
+        size_t mapSize = b.size + TASK_ARENA_BLOCK_SIZE;
+        char *map = (char *)mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+        b.base = NULL;
+        if (map != (char *)MAP_FAILED) {
+            char *aligned = (char *)(((uintptr_t)map + TASK_ARENA_BLOCK_SIZE - 1) & ~(uintptr_t)(TASK_ARENA_BLOCK_SIZE - 1));
+            if (aligned != map)
+                munmap(map, aligned - map);
+            size_t tail = (map + mapSize) - (aligned + b.size);
+            if (tail != 0)
+                munmap(aligned + b.size, tail);
+            b.base = aligned;
+#ifdef MADV_HUGEPAGE
+            b.largePages = (madvise(b.base, b.size, MADV_HUGEPAGE) == 0);
+#endif
+        }
+#else
+        b.base = (char *)malloc(b.size);
+#endif
+        if (b.base == NULL) {
+            fprintf(stderr, "Unable to allocate %zu bytes of task memory.  Exiting.\n", b.size);
+            exit(1);
+        }
+
+        TaskThreadStats &stats = lThreadStats();
+        TaskThreadStats::Bump(stats.arenaBlocks, 1);
+        TaskThreadStats::Bump(stats.largePageBlocks, b.largePages ? 1 : 0);
+        stats.arenaBytes.store(stats.arenaBytes.load(std::memory_order_relaxed) + (int64_t)b.size,
+                               std::memory_order_relaxed);
+        return b;
+    }
+
+    static void FreeBlock(const Block &b) {
+#if defined(ISPC_IS_WINDOWS)
+        VirtualFree(b.base, 0, MEM_RELEASE);
+#elif defined(ISPC_IS_LINUX) || defined(ISPC_IS_APPLE)
+        munmap(b.base, b.size);
+#else
+        free(b.base);
+#endif
+        TaskThreadStats &stats = lThreadStats();
+        stats.arenaBytes.store(stats.arenaBytes.load(std::memory_order_relaxed) - (int64_t)b.size,
+                               std::memory_order_relaxed);
+    }
+
+    std::vector<Block> blocks;
+    int curBlock = 0;
+    size_t curOffset = 0;
+};
+
+static thread_local TaskArena tlsArena;
+
 ///////////////////////////////////////////////////////////////////////////
 // TaskGroupBase
 
-#define LOG_TASK_QUEUE_CHUNK_SIZE 14
-#define MAX_TASK_QUEUE_CHUNKS 8
-#define TASK_QUEUE_CHUNK_SIZE (1 << LOG_TASK_QUEUE_CHUNK_SIZE)
+/* TaskInfo structures are held in chunks that double in size as more are
+   needed; chunk c holds indices [F * (2^c - 1), F * (2^(c+1) - 1)) where F
+   is TASK_QUEUE_FIRST_CHUNK_SIZE.  MAX_TASK_QUEUE_CHUNKS of them cover
+   every index an int can hold, so there is no limit on the number of
+   tasks launched beyond that.
+ */
+#define LOG_TASK_QUEUE_FIRST_CHUNK_SIZE 6
+#define TASK_QUEUE_FIRST_CHUNK_SIZE (1 << LOG_TASK_QUEUE_FIRST_CHUNK_SIZE)
+#define MAX_TASK_QUEUE_CHUNKS (32 - LOG_TASK_QUEUE_FIRST_CHUNK_SIZE)
 
-#define MAX_LAUNCHED_TASKS (MAX_TASK_QUEUE_CHUNKS * TASK_QUEUE_CHUNK_SIZE)
+static inline int lLog2(uint32_t v) {
+#ifdef ISPC_IS_WINDOWS
+    unsigned long index;
+    _BitScanReverse(&index, v);
+    return (int)index;
+#else
+    return 31 - __builtin_clz(v);
+#endif
+}
 
-#define NUM_MEM_BUFFERS 16
+static inline int lTaskInfoChunk(int index) { return lLog2(((uint32_t)index >> LOG_TASK_QUEUE_FIRST_CHUNK_SIZE) + 1); }
+
+static inline int lTaskInfoChunkStart(int chunk) { return TASK_QUEUE_FIRST_CHUNK_SIZE * ((1 << chunk) - 1); }
 
 class TaskGroup;
 
@@ -227,100 +469,82 @@ class TaskGroupBase {
     int nextTaskInfoIndex;
 
   private:
-    /* We allocate blocks of TASK_QUEUE_CHUNK_SIZE TaskInfo structures as
-       needed by the calling function.  We hold up to MAX_TASK_QUEUE_CHUNKS
-       of these (and then exit at runtime if more than this many tasks are
-       launched.)
+    /* Chunks of TaskInfo structures, allocated as needed by the calling
+       function and kept across Reset().  Only the launching thread adds
+       chunks, in AllocTaskInfo(), and they never move, so other threads can
+       use any TaskInfo that has been launched without taking a lock.
      */
     TaskInfo *taskInfo[MAX_TASK_QUEUE_CHUNKS];
 
-    /* We also allocate chunks of memory to service ISPCAlloc() calls.  The
-       memBuffers[] array holds pointers to this memory.  The first element
-       of this array is initialized to point to mem and then any subsequent
-       elements required are initialized with dynamic allocation.
+    /* ISPCAlloc() calls are serviced from the calling thread's TaskArena;
+       arenaMark records where it was when this group first allocated, so
+       Reset() can release everything the group used.
      */
-    int curMemBuffer, curMemBufferOffset;
-    int memBufferSize[NUM_MEM_BUFFERS];
-    char *memBuffers[NUM_MEM_BUFFERS];
-    char mem[256];
+    TaskArena *arena;
+    TaskArenaMark arenaMark;
 };
 
 inline TaskGroupBase::TaskGroupBase() {
     nextTaskInfoIndex = 0;
-
-    curMemBuffer = 0;
-    curMemBufferOffset = 0;
-    memBuffers[0] = mem;
-    memBufferSize[0] = sizeof(mem) / sizeof(mem[0]);
-    for (int i = 1; i < NUM_MEM_BUFFERS; ++i) {
-        memBuffers[i] = NULL;
-        memBufferSize[i] = 0;
-    }
+    arena = NULL;
 
     for (int i = 0; i < MAX_TASK_QUEUE_CHUNKS; ++i)
         taskInfo[i] = NULL;
 }
 
 inline TaskGroupBase::~TaskGroupBase() {
-    // Note: don't delete memBuffers[0], since it points to the start of
-    // the "mem" member!
-    for (int i = 1; i < NUM_MEM_BUFFERS; ++i)
-        delete[](memBuffers[i]);
+    for (int i = 0; i < MAX_TASK_QUEUE_CHUNKS; ++i)
+        delete[] taskInfo[i];
 }
 
 inline void TaskGroupBase::Reset() {
     nextTaskInfoIndex = 0;
-    curMemBuffer = 0;
-    curMemBufferOffset = 0;
+    if (arena != NULL) {
+        // Groups are reset by the thread that allocated from them, in
+        // ISPCSync(), so this is always our own arena.
+        assert(arena == &tlsArena);
+        arena->Release(arenaMark);
+        arena = NULL;
+    }
 }
 
 inline int TaskGroupBase::AllocTaskInfo(int count) {
     int ret = nextTaskInfoIndex;
+    if ((int64_t)ret + count > INT32_MAX) {
+        fprintf(stderr,
+                "More than %d tasks have been launched from the current function; "
+                "task indices no longer fit in an int.  Exiting.\n",
+                INT32_MAX);
+        exit(1);
+    }
     nextTaskInfoIndex += count;
+
+    if (count > 0) {
+        int lastChunk = lTaskInfoChunk(nextTaskInfoIndex - 1);
+        for (int chunk = lTaskInfoChunk(ret); chunk <= lastChunk; ++chunk)
+            if (taskInfo[chunk] == NULL)
+                taskInfo[chunk] = new TaskInfo[(size_t)TASK_QUEUE_FIRST_CHUNK_SIZE << chunk];
+    }
     return ret;
 }
 
 inline TaskInfo *TaskGroupBase::GetTaskInfo(int index) {
-    int chunk = (index >> LOG_TASK_QUEUE_CHUNK_SIZE);
-    int offset = index & (TASK_QUEUE_CHUNK_SIZE - 1);
-
-    if (chunk == MAX_TASK_QUEUE_CHUNKS) {
-        fprintf(stderr,
-                "A total of %d tasks have been launched from the "
-                "current function--the simple built-in task system can handle "
-                "no more. You can increase the values of TASK_QUEUE_CHUNK_SIZE "
-                "and LOG_TASK_QUEUE_CHUNK_SIZE to work around this limitation.  "
-                "Sorry!  Exiting.\n",
-                index);
-        exit(1);
-    }
-
-    if (taskInfo[chunk] == NULL)
-        taskInfo[chunk] = new TaskInfo[TASK_QUEUE_CHUNK_SIZE];
-    return &taskInfo[chunk][offset];
+    int chunk = lTaskInfoChunk(index);
+    assert(index < nextTaskInfoIndex && taskInfo[chunk] != NULL);
+    return &taskInfo[chunk][index - lTaskInfoChunkStart(chunk)];
 }
 
 inline void *TaskGroupBase::AllocMemory(int64_t size, int32_t alignment) {
-    char *basePtr = memBuffers[curMemBuffer];
-    intptr_t iptr = (intptr_t)(basePtr + curMemBufferOffset);
-    iptr = (iptr + (alignment - 1)) & ~(alignment - 1);
-
-    int newOffset = int(iptr - (intptr_t)basePtr + size);
-    if (newOffset < memBufferSize[curMemBuffer]) {
-        curMemBufferOffset = newOffset;
-        return (char *)iptr;
+    if (arena == NULL) {
+        arena = &tlsArena;
+        arenaMark = arena->Mark();
     }
 
-    ++curMemBuffer;
-    curMemBufferOffset = 0;
-    assert(curMemBuffer < NUM_MEM_BUFFERS);
+    TaskThreadStats &stats = lThreadStats();
+    TaskThreadStats::Bump(stats.allocations, 1);
+    TaskThreadStats::Bump(stats.allocatedBytes, (uint64_t)size);
 
-    int allocSize = 1 << (12 + curMemBuffer);
-    allocSize = std::max(int(size + alignment), allocSize);
-    char *newBuf = new char[allocSize];
-    memBufferSize[curMemBuffer] = allocSize;
-    memBuffers[curMemBuffer] = newBuf;
-    return AllocMemory(size, alignment);
+    return arena->Alloc(size, alignment);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -361,6 +585,235 @@ static inline int32_t lAtomicAdd(volatile int32_t *v, int32_t delta) {
 #endif
 }
 
+///////////////////////////////////////////////////////////////////////////
+// Task system configuration (see tasksys.h)
+
+/* Settings used the next time the thread pool is created.  They start out
+   from the TETHER_TASK_* environment variables, unless ConfigureTaskSystem()
+   has been called explicitly.
+ */
+struct TaskSystemSettings {
+    int numThreads = 0;
+    TaskSystemPinning pinning = TaskSystemPinning::None;
+    std::string cpuList;
+};
+
+static TaskSystemSettings taskSystemSettings;
+static bool taskSystemConfigured = false;
+
+// Only the thread pool backends create their own workers, so only they read
+// the settings back; the others accept ConfigureTaskSystem() and ignore it.
+#ifdef ISPC_USE_THREAD_POOL
+
+/** Parse a CPU list such as "0-3,8,10-11" into individual CPU ids.  Ids
+    past the CPUs the system has are dropped, so a range such as "0-999999"
+    expands to at most one entry per CPU.  Returns false if the string is
+    malformed or names none of the CPUs. */
+static bool lParseCpuList(const char *list, std::vector<int> &cpus) {
+    cpus.clear();
+    const long cpuCount = std::max(sysconf(_SC_NPROCESSORS_CONF), 1L);
+    const char *p = list;
+    while (*p != '\0') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0)
+            return false;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            ++p;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first)
+                return false;
+            p = end;
+        }
+        for (long c = first; c <= std::min(last, cpuCount - 1); ++c)
+            cpus.push_back((int)c);
+        if (*p == ',')
+            ++p;
+        else if (*p != '\0')
+            return false;
+    }
+    return !cpus.empty();
+}
+
+static void lReadEnvironmentSettings(TaskSystemSettings &settings) {
+    const char *env;
+    if ((env = getenv("TETHER_TASK_THREADS")) != NULL && *env != '\0') {
+        char *end;
+        long n = strtol(env, &end, 10);
+        if (*end != '\0' || n < 0)
+            fprintf(stderr, "Ignoring invalid TETHER_TASK_THREADS=\"%s\"\n", env);
+        else
+            settings.numThreads = (int)n;
+    }
+    if ((env = getenv("TETHER_TASK_CPUS")) != NULL && *env != '\0') {
+        std::vector<int> cpus;
+        if (!lParseCpuList(env, cpus))
+            fprintf(stderr, "Ignoring invalid TETHER_TASK_CPUS=\"%s\"\n", env);
+        else
+            settings.cpuList = env;
+    }
+    if ((env = getenv("TETHER_TASK_PINNING")) != NULL && *env != '\0') {
+        if (strcmp(env, "none") == 0)
+            settings.pinning = TaskSystemPinning::None;
+        else if (strcmp(env, "compact") == 0)
+            settings.pinning = TaskSystemPinning::Compact;
+        else if (strcmp(env, "scatter") == 0)
+            settings.pinning = TaskSystemPinning::Scatter;
+        else
+            fprintf(stderr, "Ignoring invalid TETHER_TASK_PINNING=\"%s\" (expected none, compact or scatter)\n", env);
+    }
+}
+
+/** Returns the settings to create the thread pool with; called from
+    InitTaskSystem() with the backend's init lock held. */
+static const TaskSystemSettings &lCurrentSettings() {
+    if (!taskSystemConfigured) {
+        lReadEnvironmentSettings(taskSystemSettings);
+        taskSystemConfigured = true;
+    }
+    return taskSystemSettings;
+}
+
+#endif // ISPC_USE_THREAD_POOL
+
+#if defined(ISPC_USE_THREAD_POOL) && defined(ISPC_IS_LINUX)
+#include <sched.h>
+
+static int lReadTopologyValue(int cpu, const char *name, int fallback) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return fallback;
+    int value = fallback;
+    if (fscanf(f, "%d", &value) != 1)
+        value = fallback;
+    fclose(f);
+    return value;
+}
+
+struct CpuTopology {
+    int cpu, package, core, sibling, coreRank;
+};
+
+/** The CPUs workers may run on, ordered for the requested pinning policy:
+    compact keeps the hyper-threads of a core together, scatter visits every
+    physical core (alternating packages) before using any second sibling. */
+static std::vector<int> lWorkerCpus(const TaskSystemSettings &settings) {
+    std::vector<int> cpus;
+    if (settings.cpuList.empty() || !lParseCpuList(settings.cpuList.c_str(), cpus)) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (int c = 0; c < CPU_SETSIZE; ++c)
+                if (CPU_ISSET(c, &allowed))
+                    cpus.push_back(c);
+        }
+    }
+
+    if (settings.pinning == TaskSystemPinning::None || cpus.size() < 2)
+        return cpus;
+
+    std::vector<CpuTopology> topo;
+    for (int c : cpus) {
+        CpuTopology t;
+        t.cpu = c;
+        t.package = lReadTopologyValue(c, "physical_package_id", 0);
+        t.core = lReadTopologyValue(c, "core_id", c);
+        t.sibling = 0;
+        t.coreRank = 0;
+        for (const CpuTopology &o : topo)
+            if (o.package == t.package && o.core == t.core)
+                ++t.sibling;
+        topo.push_back(t);
+    }
+
+    if (settings.pinning == TaskSystemPinning::Compact) {
+        std::stable_sort(topo.begin(), topo.end(), [](const CpuTopology &a, const CpuTopology &b) {
+            if (a.package != b.package)
+                return a.package < b.package;
+            if (a.core != b.core)
+                return a.core < b.core;
+            return a.cpu < b.cpu;
+        });
+    } else {
+        // Rank each core within its package, so that packages can be interleaved
+        std::vector<std::pair<int, int>> cores;
+        for (const CpuTopology &t : topo)
+            cores.push_back(std::make_pair(t.package, t.core));
+        std::sort(cores.begin(), cores.end());
+        cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+        for (CpuTopology &t : topo) {
+            t.coreRank = 0;
+            for (const std::pair<int, int> &c : cores)
+                if (c.first == t.package && c.second < t.core)
+                    ++t.coreRank;
+        }
+
+        std::stable_sort(topo.begin(), topo.end(), [](const CpuTopology &a, const CpuTopology &b) {
+            if (a.sibling != b.sibling)
+                return a.sibling < b.sibling;
+            if (a.coreRank != b.coreRank)
+                return a.coreRank < b.coreRank;
+            return a.package < b.package;
+        });
+    }
+
+    cpus.clear();
+    for (const CpuTopology &t : topo)
+        cpus.push_back(t.cpu);
+    return cpus;
+}
+
+/** Number of workers to create when the settings don't specify one. */
+static int lDefaultWorkerCount(const TaskSystemSettings &settings) {
+    int available = (int)lWorkerCpus(settings).size();
+    if (available == 0)
+        available = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return std::max(available - 1, 0);
+}
+
+/** Restrict a freshly created worker to its CPU(s); with pinning each
+    worker gets a single CPU, otherwise the whole allowed set. */
+static void lApplyWorkerAffinity(pthread_t thread, int workerIndex, const std::vector<int> &cpus,
+                                 TaskSystemPinning pinning) {
+    if (cpus.empty())
+        return;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (pinning == TaskSystemPinning::None) {
+        for (int c : cpus)
+            CPU_SET(c, &cpuset);
+    } else {
+        CPU_SET(cpus[workerIndex % cpus.size()], &cpuset);
+    }
+
+    int err = pthread_setaffinity_np(thread, sizeof(cpuset), &cpuset);
+    if (err != 0)
+        fprintf(stderr, "Error setting affinity for worker %d: %s\n", workerIndex, strerror(err));
+}
+
+#elif defined(ISPC_USE_THREAD_POOL)
+
+static std::vector<int> lWorkerCpus(const TaskSystemSettings &) { return std::vector<int>(); }
+
+static int lDefaultWorkerCount(const TaskSystemSettings &) {
+    return std::max((int)sysconf(_SC_NPROCESSORS_ONLN) - 1, 0);
+}
+
+static void lApplyWorkerAffinity(pthread_t, int, const std::vector<int> &, TaskSystemPinning) {}
+
+#endif // ISPC_USE_THREAD_POOL && ISPC_IS_LINUX
+
+#ifdef ISPC_USE_THREAD_POOL
+static int lWorkerCount(const TaskSystemSettings &settings) {
+    return (settings.numThreads > 0) ? settings.numThreads : lDefaultWorkerCount(settings);
+}
+#endif // ISPC_USE_THREAD_POOL
+
 ///////////////////////////////////////////////////////////////////////////
 
 #ifdef ISPC_USE_CONCRT
@@ -390,13 +843,21 @@ class TaskGroup : public TaskGroupBase {
 #endif // ISPC_USE_GCD
 
 #ifdef ISPC_USE_PTHREADS
+/** A run of tasks [begin, end) from the launch described by 'launch'. */
+struct TaskRange {
+    TaskInfo *launch;
+    int begin, end;
+};
+
 static void *lTaskEntry(void *arg);
+static inline TaskRange lPopWaitingTasks(TaskGroup *tg);
+static inline void lExecuteTasks(TaskGroup *tg, const TaskRange &range, int threadIndex);
 
 class TaskGroup : public TaskGroupBase {
   public:
     TaskGroup() {
         numUnfinishedTasks = 0;
-        waitingTasks.reserve(128);
+        waitingTasks.reserve(16);
         inActiveList = false;
     }
 
@@ -407,20 +868,51 @@ class TaskGroup : public TaskGroupBase {
         lMemFence();
     }
 
-    void Launch(int baseIndex, int count);
+    void Launch(int launchIndex, int count);
     void Sync();
 
   private:
     friend void *lTaskEntry(void *arg);
+    friend TaskRange lPopWaitingTasks(TaskGroup *tg);
+    friend void lExecuteTasks(TaskGroup *tg, const TaskRange &range, int threadIndex);
 
     int32_t numUnfinishedTasks;
     int32_t pad[3];
-    std::vector<int> waitingTasks;
+    // One entry per launch, holding the tasks nobody has picked up yet
+    std::vector<TaskRange> waitingTasks;
     bool inActiveList;
 };
 
 #endif // ISPC_USE_PTHREADS
 
+#ifdef ISPC_USE_WORK_STEALING
+struct WSTaskRange;
+static void lWSRunRange(WSTaskRange *range, int threadIndex);
+
+/* With the work-stealing scheduler the tasks themselves live as ranges in
+   the per-thread deques until they are run, so a task group only needs to
+   track how many of its tasks are still outstanding.
+ */
+class TaskGroup : public TaskGroupBase {
+  public:
+    TaskGroup() { numUnfinishedTasks = 0; }
+
+    void Reset() {
+        TaskGroupBase::Reset();
+        numUnfinishedTasks = 0;
+    }
+
+    void Launch(int launchIndex, int count);
+    void Sync();
+
+  private:
+    friend void lWSRunRange(WSTaskRange *range, int threadIndex);
+
+    std::atomic<int32_t> numUnfinishedTasks;
+};
+
+#endif // ISPC_USE_WORK_STEALING
+
 #ifdef ISPC_USE_OMP
 
 class TaskGroup : public TaskGroupBase {
@@ -572,12 +1064,120 @@ static int nThreads;
 static pthread_t *threads = NULL;
 
 static pthread_mutex_t taskSysMutex;
+static pthread_cond_t taskSysCond;
 static std::vector<TaskGroup *> activeTaskGroups;
 static sem_t *workerSemaphore;
+static volatile int32_t shuttingDown = 0;
+
+/* Threads blocked in Sync() wait on taskSysCond (with taskSysMutex held)
+   rather than spinning; it is broadcast whenever new tasks are added to
+   the active list and whenever the last task of a group finishes.
+
+   Sync() runs tasks from any active group while it waits, so a task that
+   itself launches and syncs never idles a pool thread.  To keep the stack
+   bounded when that happens many levels deep, a thread that is already
+   MAX_SYNC_HELP_DEPTH tasks deep only picks up tasks from the group it is
+   waiting on.
+
+   Each launch sits in its group's waiting list as a single range of task
+   indices, and threads take tasks from it in chunks: 1 / (TASK_CHUNKS_PER_THREAD
+   * threads) of whatever is left each time, but at least one task.  So
+   small launches are still handed out one task at a time, while a launch
+   of a million tiny tasks costs a few hundred trips through taskSysMutex
+   rather than a million.
+ */
+#define MAX_SYNC_HELP_DEPTH 32
+#define TASK_CHUNKS_PER_THREAD 2
+#define MAX_EXTERNAL_THREADS 16
+
+// Index reported to ispc tasks as threadIndex; pool threads are numbered
+// 0..nThreads-1, and each thread from outside the pool is given its own
+// index after those the first time it launches or syncs.  The threadCount
+// tasks see is nThreads + MAX_EXTERNAL_THREADS, so it bounds every index
+// handed out and per-thread scratch indexed by threadIndex is never shared.
+static thread_local int tlsThreadIndex = -1;
+static thread_local int tlsThreadGeneration = -1;
+static thread_local int tlsHelpDepth = 0;
+
+static std::atomic<int32_t> nExternalThreads(0);
+
+// Bumped every time the pool is torn down, so threads from outside the pool
+// know to ask for a fresh index in the new one.
+static int poolGeneration = 0;
+
+static inline int lCurrentThreadIndex() {
+    if (tlsThreadIndex < 0 || tlsThreadGeneration != poolGeneration) {
+        int slot = nExternalThreads.fetch_add(1);
+        if (slot >= MAX_EXTERNAL_THREADS) {
+            fprintf(stderr,
+                    "More than %d threads outside of the task system have launched tasks; "
+                    "increase MAX_EXTERNAL_THREADS.  Exiting.\n",
+                    MAX_EXTERNAL_THREADS);
+            exit(1);
+        }
+        tlsThreadIndex = nThreads + slot;
+        tlsThreadGeneration = poolGeneration;
+    }
+    return tlsThreadIndex;
+}
+
+/** Take the next chunk of waiting tasks from the given group.  Must be
+    called with taskSysMutex held, and only for a group that has tasks
+    waiting. */
+static inline TaskRange lPopWaitingTasks(TaskGroup *tg) {
+    assert(tg->waitingTasks.size() > 0);
+    TaskRange &waiting = tg->waitingTasks.back();
+    int take = std::max(1, (waiting.end - waiting.begin) / (TASK_CHUNKS_PER_THREAD * (nThreads + 1)));
+
+    TaskRange range = {waiting.launch, waiting.begin, waiting.begin + take};
+    waiting.begin += take;
+    if (waiting.begin == waiting.end)
+        tg->waitingTasks.pop_back();
+
+    if (tg->waitingTasks.size() == 0) {
+        // We just took the last task from this task group, so remove it
+        // from the active list.
+        if (activeTaskGroups.back() == tg)
+            activeTaskGroups.pop_back();
+        else
+            activeTaskGroups.erase(std::find(activeTaskGroups.begin(), activeTaskGroups.end(), tg));
+        tg->inActiveList = false;
+    }
+    DBG(fprintf(stderr, "took tasks %d-%d from group %p\n", range.begin, range.end - 1, tg));
+    return range;
+}
+
+/** Run a chunk of tasks and retire them from their group, waking any
+    threads waiting in Sync() if they were the last ones outstanding. */
+static inline void lExecuteTasks(TaskGroup *tg, const TaskRange &range, int threadIndex) {
+    for (int i = range.begin; i < range.end; ++i)
+        range.launch->Run(i, threadIndex, nThreads + MAX_EXTERNAL_THREADS);
+
+    //
+    // Decrement the "number of unfinished tasks" counter in the task
+    // group; lAtomicAdd() returns the previous value.  Don't touch _tg_
+    // after this point, as the thread waiting on it is free to recycle it.
+    //
+    lMemFence();
+    const int count = range.end - range.begin;
+    if (lAtomicAdd(&tg->numUnfinishedTasks, -count) == count) {
+        int err;
+        if ((err = pthread_mutex_lock(&taskSysMutex)) != 0) {
+            fprintf(stderr, "Error from pthread_mutex_lock: %s\n", strerror(err));
+            exit(1);
+        }
+        pthread_cond_broadcast(&taskSysCond);
+        if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
+            fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
+            exit(1);
+        }
+    }
+}
 
 static void *lTaskEntry(void *arg) {
     int threadIndex = (int)((int64_t)arg);
-    int threadCount = nThreads;
+    tlsThreadIndex = threadIndex;
+    tlsThreadGeneration = poolGeneration;
 
     while (1) {
         int err;
@@ -590,61 +1190,50 @@ static void *lTaskEntry(void *arg) {
             exit(1);
         }
 
+        if (shuttingDown)
+            break;
+
         //
-        // Acquire the mutex
+        // Launches only post enough to wake each worker once, so keep
+        // taking work until there is none left before sleeping again.
         //
-        if ((err = pthread_mutex_lock(&taskSysMutex)) != 0) {
-            fprintf(stderr, "Error from pthread_mutex_lock: %s\n", strerror(err));
-            exit(1);
-        }
+        while (1) {
+            //
+            // Acquire the mutex
+            //
+            if ((err = pthread_mutex_lock(&taskSysMutex)) != 0) {
+                fprintf(stderr, "Error from pthread_mutex_lock: %s\n", strerror(err));
+                exit(1);
+            }
+
+            if (activeTaskGroups.size() == 0) {
+                //
+                // Task queue is empty, go back and wait on the semaphore
+                //
+                if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
+                    fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
+                    exit(1);
+                }
+                break;
+            }
 
-        if (activeTaskGroups.size() == 0) {
             //
-            // Task queue is empty, go back and wait on the semaphore
+            // Get the last task group on the active list and the next
+            // chunk of tasks from its waiting tasks list.
             //
+            TaskGroup *tg = activeTaskGroups.back();
+            TaskRange myTasks = lPopWaitingTasks(tg);
+
             if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
                 fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
                 exit(1);
             }
-            continue;
-        }
-
-        //
-        // Get the last task group on the active list and the last task
-        // from its waiting tasks list.
-        //
-        TaskGroup *tg = activeTaskGroups.back();
-        assert(tg->waitingTasks.size() > 0);
-        int taskNumber = tg->waitingTasks.back();
-        tg->waitingTasks.pop_back();
 
-        if (tg->waitingTasks.size() == 0) {
-            // We just took the last task from this task group, so remove
-            // it from the active list.
-            activeTaskGroups.pop_back();
-            tg->inActiveList = false;
-        }
-
-        if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
-            fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
-            exit(1);
+            //
+            // And now actually run the tasks
+            //
+            lExecuteTasks(tg, myTasks, threadIndex);
         }
-
-        //
-        // And now actually run the task
-        //
-        DBG(fprintf(stderr, "running task %d from group %p\n", taskNumber, tg));
-        TaskInfo *myTask = tg->GetTaskInfo(taskNumber);
-        myTask->func(myTask->data, threadIndex, threadCount, myTask->taskIndex, myTask->taskCount(),
-                     myTask->taskIndex0(), myTask->taskIndex1(), myTask->taskIndex2(), myTask->taskCount0(),
-                     myTask->taskCount1(), myTask->taskCount2());
-
-        //
-        // Decrement the "number of unfinished tasks" counter in the task
-        // group.
-        //
-        lMemFence();
-        lAtomicAdd(&tg->numUnfinishedTasks, -1);
     }
 
     pthread_exit(NULL);
@@ -656,16 +1245,22 @@ static void InitTaskSystem() {
         while (1) {
             if (lAtomicCompareAndSwap32(&lock, 1, 0) == 0) {
                 if (threads == NULL) {
-                    // We launch one fewer thread than there are cores,
-                    // since the main thread here will also grab jobs from
-                    // the task queue itself.
-                    nThreads = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+                    // By default we launch one fewer thread than there are
+                    // cores, since the main thread here will also grab jobs
+                    // from the task queue itself.
+                    const TaskSystemSettings &settings = lCurrentSettings();
+                    const std::vector<int> workerCpus = lWorkerCpus(settings);
+                    nThreads = lWorkerCount(settings);
 
                     int err;
                     if ((err = pthread_mutex_init(&taskSysMutex, NULL)) != 0) {
                         fprintf(stderr, "Error creating mutex: %s\n", strerror(err));
                         exit(1);
                     }
+                    if ((err = pthread_cond_init(&taskSysCond, NULL)) != 0) {
+                        fprintf(stderr, "Error creating condition variable: %s\n", strerror(err));
+                        exit(1);
+                    }
 
                     char name[32];
                     bool success = false;
@@ -675,6 +1270,9 @@ static void InitTaskSystem() {
                         sprintf(name, "/ispc_task.%d.%d", (int)getpid(), (int)rand());
                         workerSemaphore = sem_open(name, O_CREAT, S_IRUSR | S_IWUSR, 0);
                         if (workerSemaphore != SEM_FAILED) {
+                            // We hold the only handle we need; remove the
+                            // name so it doesn't outlive the process.
+                            sem_unlink(name);
                             success = true;
                             break;
                         }
@@ -686,13 +1284,14 @@ static void InitTaskSystem() {
                         exit(1);
                     }
 
-                    threads = (pthread_t *)malloc(nThreads * sizeof(pthread_t));
+                    threads = (pthread_t *)malloc(std::max(nThreads, 1) * sizeof(pthread_t));
                     for (int i = 0; i < nThreads; ++i) {
                         err = pthread_create(&threads[i], NULL, &lTaskEntry, (void *)((long long)i));
                         if (err != 0) {
                             fprintf(stderr, "Error creating pthread %d: %s\n", i, strerror(err));
                             exit(1);
                         }
+                        lApplyWorkerAffinity(threads[i], i, workerCpus, settings.pinning);
                     }
 
                     activeTaskGroups.reserve(64);
@@ -708,7 +1307,47 @@ static void InitTaskSystem() {
     }
 }
 
-inline void TaskGroup::Launch(int baseCoord, int count) {
+static void lShutdownThreadPool() {
+    while (lAtomicCompareAndSwap32(&lock, 1, 0) != 0)
+        ;
+
+    if (threads != NULL) {
+        assert(activeTaskGroups.size() == 0);
+
+        // Wake every worker and have them exit rather than look for work
+        shuttingDown = 1;
+        lMemFence();
+        for (int i = 0; i < nThreads; ++i)
+            sem_post(workerSemaphore);
+        for (int i = 0; i < nThreads; ++i)
+            pthread_join(threads[i], NULL);
+
+        free(threads);
+        sem_close(workerSemaphore);
+        pthread_cond_destroy(&taskSysCond);
+        pthread_mutex_destroy(&taskSysMutex);
+        nThreads = 0;
+        nExternalThreads.store(0);
+        ++poolGeneration;
+        shuttingDown = 0;
+        threads = NULL;
+    }
+
+    lMemFence();
+    lock = 0;
+}
+
+static int lRunningThreadCount() { return (threads != NULL) ? nThreads : 0; }
+
+inline void TaskGroup::Launch(int launchIndex, int count) {
+    //
+    // Update the count of the number of tasks left to run in this task
+    // group; this has to happen before any of them can be picked up, so
+    // that the last one to finish is the one that sees the count hit zero.
+    //
+    lMemFence();
+    lAtomicAdd(&numUnfinishedTasks, count);
+
     //
     // Acquire mutex, add task
     //
@@ -718,15 +1357,14 @@ inline void TaskGroup::Launch(int baseCoord, int count) {
         exit(1);
     }
 
-    // Add the corresponding set of tasks to the waiting-to-be-run list for
-    // this task group.
+    // Add the launch to the waiting-to-be-run list for this task group.
     //
     // FIXME: it's a little ugly to hold a global mutex for this when we
     // only need to make sure no one else is accessing this task group's
     // waitingTasks list.  (But a small experiment in switching to a
     // per-TaskGroup mutex showed worse performance!)
-    for (int i = 0; i < count; ++i)
-        waitingTasks.push_back(baseCoord + i);
+    TaskRange range = {GetTaskInfo(launchIndex), 0, count};
+    waitingTasks.push_back(range);
 
     // Add the task group to the global active list if it isn't there
     // already.
@@ -735,23 +1373,21 @@ inline void TaskGroup::Launch(int baseCoord, int count) {
         inActiveList = true;
     }
 
+    // Let any threads sleeping in Sync() know there is work they can help with
+    pthread_cond_broadcast(&taskSysCond);
+
     if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
         fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
         exit(1);
     }
 
-    //
-    // Update the count of the number of tasks left to run in this task
-    // group.
-    //
-    lMemFence();
-    lAtomicAdd(&numUnfinishedTasks, count);
-
     //
     // Post to the worker semaphore to wake up worker threads that are
-    // sleeping waiting for tasks to show up
+    // sleeping waiting for tasks to show up; each one keeps going until the
+    // work runs out, so there's no need to post more than once per worker.
     //
-    for (int i = 0; i < count; ++i)
+    const int wakeCount = std::min(count, nThreads);
+    for (int i = 0; i < wakeCount; ++i)
         if ((err = sem_post(workerSemaphore)) != 0) {
             fprintf(stderr, "Error from sem_post: %s\n", strerror(err));
             exit(1);
@@ -759,96 +1395,458 @@ inline void TaskGroup::Launch(int baseCoord, int count) {
 }
 
 inline void TaskGroup::Sync() {
-    DBG(fprintf(stderr, "syncing %p - %d unfinished\n", tg, numUnfinishedTasks));
+    DBG(fprintf(stderr, "syncing %p - %d unfinished\n", this, numUnfinishedTasks));
+
+    int threadIndex = lCurrentThreadIndex();
+
+    int err;
+    if ((err = pthread_mutex_lock(&taskSysMutex)) != 0) {
+        fprintf(stderr, "Error from pthread_mutex_lock: %s\n", strerror(err));
+        exit(1);
+    }
 
     while (numUnfinishedTasks > 0) {
         // All of the tasks in this group aren't finished yet.  We'll try
-        // to help out here since we don't have anything else to do...
+        // to help out here since we don't have anything else to do; first
+        // with our own tasks, then with anyone else's.
+        TaskGroup *runtg = NULL;
+        if (waitingTasks.size() > 0)
+            runtg = this;
+        else if (activeTaskGroups.size() > 0 && tlsHelpDepth < MAX_SYNC_HELP_DEPTH)
+            runtg = activeTaskGroups.back();
 
-        DBG(fprintf(stderr, "while syncing %p - %d unfinished\n", tg, numUnfinishedTasks));
+        if (runtg == NULL) {
+            // Other threads are already running everything left in this
+            // group and there's nothing else we may pick up; sleep until
+            // a group finishes or more tasks are launched.
+            DBG(fprintf(stderr, "while syncing %p - %d unfinished, waiting\n", this, numUnfinishedTasks));
+            if ((err = pthread_cond_wait(&taskSysCond, &taskSysMutex)) != 0) {
+                fprintf(stderr, "Error from pthread_cond_wait: %s\n", strerror(err));
+                exit(1);
+            }
+            continue;
+        }
+
+        TaskRange myTasks = lPopWaitingTasks(runtg);
+
+        if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
+            fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
+            exit(1);
+        }
 
         //
-        // Acquire the global task system mutex to grab a task to work on
+        // Do work for _myTasks_
         //
-        int err;
+        ++tlsHelpDepth;
+        lExecuteTasks(runtg, myTasks, threadIndex);
+        --tlsHelpDepth;
+
         if ((err = pthread_mutex_lock(&taskSysMutex)) != 0) {
             fprintf(stderr, "Error from pthread_mutex_lock: %s\n", strerror(err));
             exit(1);
         }
+    }
 
-        TaskInfo *myTask = NULL;
-        TaskGroup *runtg = this;
-        if (waitingTasks.size() > 0) {
-            int taskNumber = waitingTasks.back();
-            waitingTasks.pop_back();
-
-            if (waitingTasks.size() == 0) {
-                // There's nothing left to start running from this group,
-                // so remove it from the active task list.
-                activeTaskGroups.erase(std::find(activeTaskGroups.begin(), activeTaskGroups.end(), this));
-                inActiveList = false;
-            }
-            myTask = GetTaskInfo(taskNumber);
-            DBG(fprintf(stderr, "running task %d from group %p in sync\n", taskNumber, tg));
-        } else {
-            // Other threads are already working on all of the tasks in
-            // this group, so we can't help out by running one ourself.
-            // We'll try to run one from another group to make ourselves
-            // useful here.
-            if (activeTaskGroups.size() == 0) {
-                // No active task groups left--there's nothing for us to do.
-                if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
-                    fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
-                    exit(1);
-                }
-                // FIXME: We basically end up busy-waiting here, which is
-                // extra wasteful in a world with hyper-threading.  It would
-                // be much better to put this thread to sleep on a
-                // condition variable that was signaled when the last task
-                // in this group was finished.
-                usleep(1);
-                continue;
-            }
+    if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
+        fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
+        exit(1);
+    }
+    DBG(fprintf(stderr, "sync for %p done!\n", this));
+}
 
-            // Get a task to run from another task group.
-            runtg = activeTaskGroups.back();
-            assert(runtg->waitingTasks.size() > 0);
-
-            int taskNumber = runtg->waitingTasks.back();
-            runtg->waitingTasks.pop_back();
-            if (runtg->waitingTasks.size() == 0) {
-                // There's left to start running from this group, so remove
-                // it from the active task list.
-                activeTaskGroups.pop_back();
-                runtg->inActiveList = false;
+#endif // ISPC_USE_PTHREADS
+
+///////////////////////////////////////////////////////////////////////////
+// work-stealing
+
+#ifdef ISPC_USE_WORK_STEALING
+
+/* A task system built from one Chase-Lev deque per thread (see "Dynamic
+   Circular Work-Stealing Deque", Chase & Lev, SPAA 2005, and the C11
+   formulation in "Correct and Efficient Work-Stealing for Weak Memory
+   Models", Le et al., PPoPP 2013).
+
+   ISPCLaunch() pushes a single range of task indices onto the launching
+   thread's deque.  Whichever thread picks a range up repeatedly splits it
+   in half, pushing the upper half back onto its own deque where idle
+   threads can steal it, until no more than the launch's grain is left to
+   run.  The grain is one task unless the launch has more than
+   WS_RANGES_PER_THREAD tasks for every thread, so very large launches are
+   run in a bounded number of ranges instead of being split down to
+   individual tasks.  The owner
+   works LIFO from the bottom of its deque (good locality for the tiles it
+   just split), thieves take the oldest, largest ranges from the top.
+
+   Threads that aren't part of the pool (e.g. the main thread) are given a
+   deque of their own the first time they launch or sync, so they can help
+   out with the work while they wait in ISPCSync().
+ */
+
+#define WS_LOG_INITIAL_DEQUE_SIZE 8
+#define WS_MAX_EXTERNAL_THREADS 16
+#define WS_SPINS_BEFORE_SLEEP 64
+#define WS_RANGES_PER_THREAD 16
+
+struct WSTaskRange {
+    TaskGroup *tg;
+    TaskInfo *launch;
+    int begin, end, grain;
+    WSTaskRange *nextFree;
+};
+
+/** Circular array backing a deque.  Only the owning thread ever grows it;
+    the array being replaced is kept alive on the 'previous' chain since a
+    thief may still be reading a slot from it.
+ */
+struct WSDequeArray {
+    WSDequeArray(int64_t cap, WSDequeArray *prev) : capacity(cap), previous(prev) {
+        slots = new std::atomic<WSTaskRange *>[capacity];
+    }
+    ~WSDequeArray() {
+        delete[] slots;
+        delete previous;
+    }
+
+    WSTaskRange *Get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+    void Put(int64_t i, WSTaskRange *r) { slots[i & (capacity - 1)].store(r, std::memory_order_relaxed); }
+
+    int64_t capacity;
+    WSDequeArray *previous;
+    std::atomic<WSTaskRange *> *slots;
+};
+
+class WSDeque {
+  public:
+    WSDeque() : top(0), bottom(0), array(new WSDequeArray(1 << WS_LOG_INITIAL_DEQUE_SIZE, NULL)) {}
+    ~WSDeque() { delete array.load(); }
+
+    /** Owner only: push a range onto the bottom of the deque. */
+    void Push(WSTaskRange *r) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        WSDequeArray *a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            WSDequeArray *grown = new WSDequeArray(a->capacity * 2, a);
+            for (int64_t i = t; i < b; ++i)
+                grown->Put(i, a->Get(i));
+            array.store(grown, std::memory_order_release);
+            a = grown;
+        }
+        a->Put(b, r);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    /** Owner only: take the most recently pushed range, or NULL. */
+    WSTaskRange *Pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        WSDequeArray *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        WSTaskRange *r = NULL;
+        if (t <= b) {
+            r = a->Get(b);
+            if (t == b) {
+                // Last entry; race any thieves for it.
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    r = NULL;
+                bottom.store(b + 1, std::memory_order_relaxed);
             }
-            myTask = runtg->GetTaskInfo(taskNumber);
-            DBG(fprintf(stderr, "running task %d from other group %p in sync\n", taskNumber, runtg));
+        } else {
+            bottom.store(b + 1, std::memory_order_relaxed);
         }
+        return r;
+    }
 
-        if ((err = pthread_mutex_unlock(&taskSysMutex)) != 0) {
-            fprintf(stderr, "Error from pthread_mutex_unlock: %s\n", strerror(err));
+    /** Any thread: take the oldest range from the top of the deque, or
+        NULL if it's empty or another thread won the race for it.  The
+        returned range belongs to the caller. */
+    WSTaskRange *Steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return NULL;
+
+        WSDequeArray *a = array.load(std::memory_order_acquire);
+        WSTaskRange *r = a->Get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return NULL;
+        return r;
+    }
+
+  private:
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    std::atomic<WSDequeArray *> array;
+};
+
+static volatile int32_t lock = 0;
+
+static int nWorkers;
+static int nThreadSlots;
+static pthread_t *threads = NULL;
+static WSDeque *deques = NULL;
+static std::atomic<int32_t> nExternalThreads(0);
+static std::atomic<bool> wsShuttingDown(false);
+
+// Bumped every time the pool is torn down, so threads from outside the pool
+// know to ask for a fresh deque slot in the new one.
+static int wsGeneration = 0;
+
+// Idle workers sleep on wsSleepCond once every deque has come up empty;
+// launches bump wsWorkEpoch and only touch the mutex if anyone is asleep.
+static pthread_mutex_t wsSleepMutex;
+static pthread_cond_t wsSleepCond;
+static std::atomic<uint32_t> wsWorkEpoch(0);
+static std::atomic<int32_t> wsSleepers(0);
+
+static thread_local int wsThreadIndex = -1;
+static thread_local int wsThreadGeneration = -1;
+static thread_local uint32_t wsStealSeed = 0;
+static thread_local WSTaskRange *wsFreeRanges = NULL;
+
+/** Ranges are recycled through a per-thread free list; whoever takes a
+    range from a deque owns it from then on, so it can go onto the taker's
+    list regardless of which thread allocated it. */
+static inline WSTaskRange *lWSAllocRange(TaskGroup *tg, TaskInfo *launch, int begin, int end, int grain) {
+    WSTaskRange *r = wsFreeRanges;
+    if (r != NULL)
+        wsFreeRanges = r->nextFree;
+    else
+        r = new WSTaskRange;
+    r->tg = tg;
+    r->launch = launch;
+    r->begin = begin;
+    r->end = end;
+    r->grain = grain;
+    return r;
+}
+
+static inline void lWSFreeRange(WSTaskRange *r) {
+    r->nextFree = wsFreeRanges;
+    wsFreeRanges = r;
+}
+
+static inline void lWSWakeWorkers() {
+    wsWorkEpoch.fetch_add(1);
+    if (wsSleepers.load() > 0) {
+        pthread_mutex_lock(&wsSleepMutex);
+        pthread_cond_broadcast(&wsSleepCond);
+        pthread_mutex_unlock(&wsSleepMutex);
+    }
+}
+
+/** Returns the calling thread's deque slot, handing out one of the spare
+    slots to threads from outside the pool on first use. */
+static inline int lWSThreadIndex() {
+    if (wsThreadIndex < 0 || wsThreadGeneration != wsGeneration) {
+        int slot = nExternalThreads.fetch_add(1);
+        if (slot >= WS_MAX_EXTERNAL_THREADS) {
+            fprintf(stderr,
+                    "More than %d threads outside of the task system have launched tasks; "
+                    "increase WS_MAX_EXTERNAL_THREADS.  Exiting.\n",
+                    WS_MAX_EXTERNAL_THREADS);
             exit(1);
         }
+        wsThreadIndex = nWorkers + slot;
+        wsThreadGeneration = wsGeneration;
+        wsStealSeed = (uint32_t)wsThreadIndex * 2654435761u + 1;
+    }
+    return wsThreadIndex;
+}
 
-        //
-        // Do work for _myTask_
-        //
-        // FIXME: bogus values for thread index/thread count here as well..
-        myTask->func(myTask->data, 0, 1, myTask->taskIndex, myTask->taskCount(), myTask->taskIndex0(),
-                     myTask->taskIndex1(), myTask->taskIndex2(), myTask->taskCount0(), myTask->taskCount1(),
-                     myTask->taskCount2());
+/** Pop from our own deque first, then try to steal from every other
+    registered deque, starting from a random victim. */
+static WSTaskRange *lWSFindWork(int threadIndex) {
+    WSTaskRange *r = deques[threadIndex].Pop();
+    if (r != NULL)
+        return r;
+
+    int nActive = nWorkers + std::min((int)nExternalThreads.load(std::memory_order_relaxed), WS_MAX_EXTERNAL_THREADS);
+    wsStealSeed = wsStealSeed * 1664525u + 1013904223u;
+    int start = (int)((wsStealSeed >> 8) % (uint32_t)nActive);
+    for (int i = 0; i < nActive; ++i) {
+        int victim = (start + i) % nActive;
+        if (victim == threadIndex)
+            continue;
+        r = deques[victim].Steal();
+        if (r != NULL)
+            return r;
+    }
+    return NULL;
+}
+
+static void lWSRunRange(WSTaskRange *range, int threadIndex) {
+    TaskGroup *tg = range->tg;
+    TaskInfo *launch = range->launch;
+    int begin = range->begin;
+    int end = range->end;
+    int grain = range->grain;
+    lWSFreeRange(range);
+
+    // Split lazily; keep the lower half and expose the upper half to thieves
+    while (end - begin > grain) {
+        int mid = begin + (end - begin) / 2;
+        deques[threadIndex].Push(lWSAllocRange(tg, launch, mid, end, grain));
+        lWSWakeWorkers();
+        end = mid;
+    }
+
+    DBG(fprintf(stderr, "running tasks %d-%d from group %p on thread %d\n", begin, end - 1, tg, threadIndex));
+    for (int i = begin; i < end; ++i)
+        launch->Run(i, threadIndex, nThreadSlots);
+
+    tg->numUnfinishedTasks.fetch_sub(end - begin, std::memory_order_release);
+}
+
+static void *lWSWorkerEntry(void *arg) {
+    int threadIndex = (int)((int64_t)arg);
+    wsThreadIndex = threadIndex;
+    wsThreadGeneration = wsGeneration;
+    wsStealSeed = (uint32_t)threadIndex * 2654435761u + 1;
+
+    while (!wsShuttingDown.load()) {
+        uint32_t epoch = wsWorkEpoch.load();
+
+        WSTaskRange *range = NULL;
+        for (int spin = 0; spin < WS_SPINS_BEFORE_SLEEP && range == NULL; ++spin) {
+            range = lWSFindWork(threadIndex);
+            if (range == NULL)
+                sched_yield();
+        }
+
+        if (range != NULL) {
+            lWSRunRange(range, threadIndex);
+            continue;
+        }
 
         //
-        // Decrement the number of unfinished tasks counter
+        // Nothing to do anywhere; sleep until something new is pushed.  A
+        // launch that happened after we read 'epoch' will have changed it,
+        // in which case we go straight back around.
         //
-        lMemFence();
-        lAtomicAdd(&runtg->numUnfinishedTasks, -1);
+        pthread_mutex_lock(&wsSleepMutex);
+        wsSleepers.fetch_add(1);
+        while (wsWorkEpoch.load() == epoch && !wsShuttingDown.load())
+            pthread_cond_wait(&wsSleepCond, &wsSleepMutex);
+        wsSleepers.fetch_sub(1);
+        pthread_mutex_unlock(&wsSleepMutex);
     }
-    DBG(fprintf(stderr, "sync for %p done!n", tg));
+
+    pthread_exit(NULL);
+    return 0;
 }
 
-#endif // ISPC_USE_PTHREADS
+static void InitTaskSystem() {
+    if (threads == NULL) {
+        while (1) {
+            if (lAtomicCompareAndSwap32(&lock, 1, 0) == 0) {
+                if (threads == NULL) {
+                    // As with the pthreads task system, launch one fewer
+                    // worker than there are cores by default; the launching
+                    // thread works on tasks too while it waits in ISPCSync().
+                    const TaskSystemSettings &settings = lCurrentSettings();
+                    const std::vector<int> workerCpus = lWorkerCpus(settings);
+                    nWorkers = lWorkerCount(settings);
+                    nThreadSlots = nWorkers + WS_MAX_EXTERNAL_THREADS;
+
+                    int err;
+                    if ((err = pthread_mutex_init(&wsSleepMutex, NULL)) != 0) {
+                        fprintf(stderr, "Error creating mutex: %s\n", strerror(err));
+                        exit(1);
+                    }
+                    if ((err = pthread_cond_init(&wsSleepCond, NULL)) != 0) {
+                        fprintf(stderr, "Error creating condition variable: %s\n", strerror(err));
+                        exit(1);
+                    }
+
+                    deques = new WSDeque[nThreadSlots];
+
+                    pthread_t *workerThreads = (pthread_t *)malloc(std::max(nWorkers, 1) * sizeof(pthread_t));
+                    for (int i = 0; i < nWorkers; ++i) {
+                        err = pthread_create(&workerThreads[i], NULL, &lWSWorkerEntry, (void *)((long long)i));
+                        if (err != 0) {
+                            fprintf(stderr, "Error creating pthread %d: %s\n", i, strerror(err));
+                            exit(1);
+                        }
+                        lApplyWorkerAffinity(workerThreads[i], i, workerCpus, settings.pinning);
+                    }
+
+                    // Make sure all of the above goes to memory before we
+                    // publish the thread array, which other threads test.
+                    lMemFence();
+                    threads = workerThreads;
+                }
+
+                lMemFence();
+                lock = 0;
+                break;
+            }
+        }
+    }
+}
+
+static void lShutdownThreadPool() {
+    while (lAtomicCompareAndSwap32(&lock, 1, 0) != 0)
+        ;
+
+    if (threads != NULL) {
+        wsShuttingDown.store(true);
+        pthread_mutex_lock(&wsSleepMutex);
+        pthread_cond_broadcast(&wsSleepCond);
+        pthread_mutex_unlock(&wsSleepMutex);
+        for (int i = 0; i < nWorkers; ++i)
+            pthread_join(threads[i], NULL);
+
+        free(threads);
+        delete[] deques;
+        deques = NULL;
+        pthread_cond_destroy(&wsSleepCond);
+        pthread_mutex_destroy(&wsSleepMutex);
+
+        nWorkers = 0;
+        nExternalThreads.store(0);
+        ++wsGeneration;
+        wsShuttingDown.store(false);
+        threads = NULL;
+    }
+
+    lMemFence();
+    lock = 0;
+}
+
+static int lRunningThreadCount() { return (threads != NULL) ? nWorkers : 0; }
+
+inline void TaskGroup::Launch(int launchIndex, int count) {
+    // The count has to be in place before any of the tasks can finish
+    numUnfinishedTasks.fetch_add(count, std::memory_order_relaxed);
+
+    int grain = std::max(1, count / (WS_RANGES_PER_THREAD * nThreadSlots));
+    int threadIndex = lWSThreadIndex();
+    deques[threadIndex].Push(lWSAllocRange(this, GetTaskInfo(launchIndex), 0, count, grain));
+    lWSWakeWorkers();
+}
+
+inline void TaskGroup::Sync() {
+    DBG(fprintf(stderr, "syncing %p - %d unfinished\n", this, (int)numUnfinishedTasks));
+
+    int threadIndex = lWSThreadIndex();
+    while (numUnfinishedTasks.load(std::memory_order_acquire) > 0) {
+        // Help out with anything we can find rather than just waiting;
+        // this is typically the rest of our own launch, but can also be
+        // someone else's.
+        WSTaskRange *range = lWSFindWork(threadIndex);
+        if (range != NULL)
+            lWSRunRange(range, threadIndex);
+        else
+            sched_yield();
+    }
+    DBG(fprintf(stderr, "sync for %p done!\n", this));
+}
+
+#endif // ISPC_USE_WORK_STEALING
 
 ///////////////////////////////////////////////////////////////////////////
 // OpenMP
@@ -1003,6 +2001,26 @@ void ISPCLaunch(void **taskGroupPtr, void *func, void *data, int count0, int cou
     } else
         taskGroup = (TaskGroup *)(*taskGroupPtr);
 
+    TaskThreadStats &stats = lThreadStats();
+    TaskThreadStats::Bump(stats.launches, 1);
+    TaskThreadStats::Bump(stats.tasks, (uint64_t)count);
+
+    if (count <= 0)
+        return;
+
+#ifdef ISPC_USE_LAUNCH_RANGES
+    // One TaskInfo describes the whole launch; the task system hands out
+    // ranges of task indices from it.
+    int launchIndex = taskGroup->AllocTaskInfo(1);
+    TaskInfo *ti = taskGroup->GetTaskInfo(launchIndex);
+    ti->func = (TaskFuncType)func;
+    ti->data = data;
+    ti->taskIndex = 0;
+    ti->taskCount3d[0] = count0;
+    ti->taskCount3d[1] = count1;
+    ti->taskCount3d[2] = count2;
+    taskGroup->Launch(launchIndex, count);
+#else
     int baseIndex = taskGroup->AllocTaskInfo(count);
     for (int i = 0; i < count; ++i) {
         TaskInfo *ti = taskGroup->GetTaskInfo(baseIndex + i);
@@ -1014,6 +2032,7 @@ void ISPCLaunch(void **taskGroupPtr, void *func, void *data, int count0, int cou
         ti->taskCount3d[2] = count2;
     }
     taskGroup->Launch(baseIndex, count);
+#endif // ISPC_USE_LAUNCH_RANGES
 }
 
 void ISPCSync(void *h) {
@@ -1109,13 +2128,16 @@ class TaskSys {
 
     TaskSys() : nextScheduleIndex(0) {
         TaskSys::global = this;
-        Task *mem = new Task[MAX_LIVE_TASKS]; //< could actually be more than _live_ tasks
+        taskBlock = new Task[MAX_LIVE_TASKS]; //< could actually be more than _live_ tasks
         for (int i = 0; i < MAX_LIVE_TASKS; i++) {
-            taskMem.push(mem + i);
+            taskMem.push(taskBlock + i);
         }
         createThreads();
     }
 
+    // only once shutdown() has stopped the workers
+    ~TaskSys() { delete[] taskBlock; }
+
     inline Task *allocOne() {
         pthread_mutex_lock(&mutex);
         if (taskMem.empty()) {
@@ -1139,8 +2161,11 @@ class TaskSys {
     }
 
     void createThreads();
+    void shutdown();
     int nThreads;
     pthread_t *thread;
+    Task *taskBlock;
+    volatile int shuttingDown;
 
     void threadFct();
 
@@ -1178,6 +2203,8 @@ void TaskSys::threadFct() {
     int myIndex = 0; // lAtomicAdd(&threadIdx,1);
     while (1) {
         while (!taskQueue[myIndex].active) {
+            if (shuttingDown)
+                return;
             usleep(4);
             continue;
         }
@@ -1206,11 +2233,12 @@ void *_threadFct(void *data) {
 
 void TaskSys::createThreads() {
     init();
-    int reserved = 4;
-    int minid = 2;
-    nThreads = sysconf(_SC_NPROCESSORS_ONLN) - reserved;
+    const TaskSystemSettings &settings = lCurrentSettings();
+    const std::vector<int> workerCpus = lWorkerCpus(settings);
+    nThreads = lWorkerCount(settings);
+    shuttingDown = 0;
 
-    thread = (pthread_t *)malloc(nThreads * sizeof(pthread_t));
+    thread = (pthread_t *)malloc(std::max(nThreads, 1) * sizeof(pthread_t));
 
     numThreadsRunning = 0;
     for (int i = 0; i < nThreads; ++i) {
@@ -1218,24 +2246,46 @@ void TaskSys::createThreads() {
         pthread_attr_init(&attr);
         pthread_attr_setstacksize(&attr, 2 * 1024 * 1024);
 
-        int threadID = minid + i;
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(threadID, &cpuset);
-        int ret = pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
-
         int err = pthread_create(&thread[i], &attr, &_threadFct, this);
         ++numThreadsRunning;
         if (err != 0) {
             fprintf(stderr, "Error creating pthread %d: %s\n", i, strerror(err));
             exit(1);
         }
+        lApplyWorkerAffinity(thread[i], i, workerCpus, settings.pinning);
     }
 }
 
+void TaskSys::shutdown() {
+    shuttingDown = 1;
+    lMemFence();
+    for (int i = 0; i < nThreads; ++i)
+        pthread_join(thread[i], NULL);
+    free(thread);
+    thread = NULL;
+    nThreads = 0;
+    numThreadsRunning = 0;
+}
+
 TaskSys *TaskSys::global = NULL;
 int TaskSys::numThreadsRunning = 0;
 
+static void lShutdownThreadPool() {
+    pthread_mutex_lock(&mutex);
+    TaskSys *taskSys = TaskSys::global;
+    TaskSys::global = NULL;
+    pthread_mutex_unlock(&mutex);
+
+    // Stop the workers before freeing the queues they poll; the next
+    // ISPCAlloc() creates a fresh instance, as with the other backends.
+    if (taskSys != NULL) {
+        taskSys->shutdown();
+        delete taskSys;
+    }
+}
+
+static int lRunningThreadCount() { return (TaskSys::global != NULL) ? TaskSys::global->nThreads : 0; }
+
 ///////////////////////////////////////////////////////////////////////////
 
 void ISPCLaunch(void **taskGroupPtr, void *func, void *data, int count) {
@@ -1262,3 +2312,57 @@ void *ISPCAlloc(void **taskGroupPtr, int64_t size, int32_t alignment) {
 }
 
 #endif // ISPC_USE_PTHREADS_FULLY_SUBSCRIBED
+
+///////////////////////////////////////////////////////////////////////////
+
+void ConfigureTaskSystem(const TaskSystemConfig &config) {
+    ShutdownTaskSystem();
+
+    taskSystemSettings.numThreads = std::max(config.numThreads, 0);
+    taskSystemSettings.pinning = config.pinning;
+    taskSystemSettings.cpuList = (config.cpuList != NULL) ? config.cpuList : "";
+    taskSystemConfigured = true;
+}
+
+void ShutdownTaskSystem() {
+#ifdef ISPC_USE_THREAD_POOL
+    lShutdownThreadPool();
+#endif
+}
+
+int GetTaskSystemThreadCount() {
+#ifdef ISPC_USE_THREAD_POOL
+    return lRunningThreadCount();
+#else
+    return 0;
+#endif
+}
+
+static TaskSystemStats statsBaseline;
+
+static void lSumThreadStats(TaskSystemStats &stats) {
+    stats = TaskSystemStats();
+    int64_t arenaBytes = 0;
+    for (TaskThreadStats *t = allThreadStats.load(); t != NULL; t = t->next) {
+        stats.launches += t->launches.load(std::memory_order_relaxed);
+        stats.tasks += t->tasks.load(std::memory_order_relaxed);
+        stats.allocations += t->allocations.load(std::memory_order_relaxed);
+        stats.allocatedBytes += t->allocatedBytes.load(std::memory_order_relaxed);
+        stats.arenaBlocks += t->arenaBlocks.load(std::memory_order_relaxed);
+        stats.largePageBlocks += t->largePageBlocks.load(std::memory_order_relaxed);
+        arenaBytes += t->arenaBytes.load(std::memory_order_relaxed);
+    }
+    stats.arenaBytes = (uint64_t)std::max(arenaBytes, (int64_t)0);
+}
+
+void GetTaskSystemStats(TaskSystemStats &stats) {
+    lSumThreadStats(stats);
+    stats.launches -= statsBaseline.launches;
+    stats.tasks -= statsBaseline.tasks;
+    stats.allocations -= statsBaseline.allocations;
+    stats.allocatedBytes -= statsBaseline.allocatedBytes;
+    stats.arenaBlocks -= statsBaseline.arenaBlocks;
+    stats.largePageBlocks -= statsBaseline.largePageBlocks;
+}
+
+void ResetTaskSystemStats() { lSumThreadStats(statsBaseline); }
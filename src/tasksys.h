@@ -0,0 +1,71 @@
+/*
+  Runtime control over the task system implemented in tasksys.cpp.
+
+  By default the task system starts lazily on the first ispc 'launch' with
+  one worker thread fewer than there are CPUs available to the process, and
+  leaves thread placement to the OS.  The settings below override that; they
+  can also be supplied through the environment, which is read when the task
+  system first starts (explicit calls to ConfigureTaskSystem() take
+  precedence):
+
+    TETHER_TASK_THREADS=6           number of worker threads
+    TETHER_TASK_CPUS=0-7,16-23      CPUs the workers are allowed to run on
+    TETHER_TASK_PINNING=compact     none, compact or scatter
+
+  Thread counts apply to the pthreads-based task systems (ISPC_USE_PTHREADS,
+  ISPC_USE_WORK_STEALING, ISPC_USE_PTHREADS_FULLY_SUBSCRIBED); CPU lists and
+  pinning are only applied on Linux.  Other task systems accept and ignore
+  the settings.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+enum class TaskSystemPinning {
+    None,    // workers may run on any CPU in the allowed set
+    Compact, // one worker per CPU, filling all hyper-threads of a core before moving to the next
+    Scatter, // one worker per CPU, spreading across physical cores (and packages) before doubling up
+};
+
+struct TaskSystemConfig {
+    int numThreads = 0;                                // worker threads; 0 picks one fewer than the allowed CPUs
+    TaskSystemPinning pinning = TaskSystemPinning::None;
+    const char *cpuList = nullptr;                     // eg. "0-3,8"; nullptr or "" allows every CPU the process may use
+};
+
+/** Set up the task system for the next time it starts.  If it is already
+    running it is shut down first; the new pool is created on the next
+    launch.  Must not be called while tasks are in flight. */
+void ConfigureTaskSystem(const TaskSystemConfig &config);
+
+/** Stop and join all worker threads and release the task system's OS
+    resources.  The task system restarts on the next launch, so this can be
+    used to resize the pool between phases.  Must not be called while tasks
+    are in flight. */
+void ShutdownTaskSystem();
+
+/** Number of worker threads currently running; 0 if the task system hasn't
+    started (or doesn't expose its threads). */
+int GetTaskSystemThreadCount();
+
+/** Counters covering every thread that has used the task system.  Dividing
+    allocations and allocatedBytes by launches gives the ISPCAlloc() traffic
+    per launch; arenaBlocks only grows while the per-thread arenas that back
+    ISPCAlloc() are warming up, so it should stay flat across steady frames.
+ */
+struct TaskSystemStats {
+    uint64_t launches = 0;        // ISPCLaunch() calls
+    uint64_t tasks = 0;           // tasks started by those launches
+    uint64_t allocations = 0;     // ISPCAlloc() calls
+    uint64_t allocatedBytes = 0;  // bytes requested through ISPCAlloc()
+    uint64_t arenaBlocks = 0;     // arena blocks obtained from the OS
+    uint64_t largePageBlocks = 0; // ... of which were backed by large pages
+    uint64_t arenaBytes = 0;      // arena memory currently held across all threads; not affected by a reset
+};
+
+/** Counters accumulated since the last ResetTaskSystemStats() (or startup).
+    Not covered by ISPC_USE_PTHREADS_FULLY_SUBSCRIBED, which manages its own
+    memory. */
+void GetTaskSystemStats(TaskSystemStats &stats);
+void ResetTaskSystemStats();